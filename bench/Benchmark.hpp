@@ -0,0 +1,234 @@
+//
+//  SoftwareRenderer
+//
+
+#ifndef BENCHMARK_HPP
+#define BENCHMARK_HPP
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <ostream>
+#include <string>
+#include <utility>
+#include <vector>
+#include "PerformanceCounters.hpp"
+
+namespace bench
+{
+    class Options final
+    {
+    public:
+        std::string filter; // only the benchmarks whose name contains the filter are run
+        std::string suite = "all"; // all, scenes or kernels
+        std::size_t iterations = 20; // frames of a scene benchmark
+        std::size_t repetitions = 100; // batches of a kernel benchmark
+        bool counters = true; // hardware counters are reported where the platform allows it
+    };
+
+    // frame or call times in milliseconds
+    class Statistics final
+    {
+    public:
+        std::size_t samples = 0;
+        std::size_t outliers = 0;
+        double min = 0.0;
+        double mean = 0.0;
+        double median = 0.0;
+        double p90 = 0.0;
+        double p99 = 0.0;
+        double max = 0.0;
+    };
+
+    [[nodiscard]] inline double getPercentile(const std::vector<double>& sorted, const double percentile)
+    {
+        if (sorted.empty()) return 0.0;
+
+        // linear interpolation between the closest ranks
+        const auto rank = percentile / 100.0 * static_cast<double>(sorted.size() - 1);
+        const auto lower = static_cast<std::size_t>(rank);
+        const auto upper = std::min(lower + 1, sorted.size() - 1);
+        return sorted[lower] + (sorted[upper] - sorted[lower]) * (rank - static_cast<double>(lower));
+    }
+
+    // rejecting the outliers hides the stalls caused by the rest of the system (interrupts, migrations),
+    // but it also hides the tail of the frame times, so the scene benchmarks keep all the samples
+    [[nodiscard]] inline Statistics getStatistics(std::vector<double> samples, const bool rejectOutliers = false)
+    {
+        Statistics result;
+        if (samples.empty()) return result;
+
+        std::sort(samples.begin(), samples.end());
+
+        if (rejectOutliers)
+        {
+            // samples further than 3 scaled median absolute deviations from the median
+            const auto median = getPercentile(samples, 50.0);
+
+            std::vector<double> deviations;
+            deviations.reserve(samples.size());
+            for (const auto sample : samples) deviations.push_back(std::fabs(sample - median));
+            std::sort(deviations.begin(), deviations.end());
+
+            const auto limit = 3.0 * 1.4826 * getPercentile(deviations, 50.0);
+
+            const auto size = samples.size();
+            samples.erase(std::remove_if(samples.begin(), samples.end(), [median, limit](const double sample) {
+                return std::fabs(sample - median) > limit;
+            }), samples.end());
+            result.outliers = size - samples.size();
+        }
+
+        double sum = 0.0;
+        for (const auto sample : samples) sum += sample;
+
+        result.samples = samples.size();
+        result.min = samples.front();
+        result.mean = sum / static_cast<double>(samples.size());
+        result.median = getPercentile(samples, 50.0);
+        result.p90 = getPercentile(samples, 90.0);
+        result.p99 = getPercentile(samples, 99.0);
+        result.max = samples.back();
+        return result;
+    }
+
+    // keeps the compiler from optimizing away a result that is not used otherwise
+    template <typename T>
+    void keep(const T& value) noexcept
+    {
+#if defined(__GNUC__) || defined(__clang__)
+        asm volatile("" : : "r"(&value) : "memory");
+#else
+        static const void* volatile sink;
+        sink = &value;
+#endif
+    }
+
+    // calls the function iterations times after a warm-up call and returns the times in milliseconds,
+    // prepare is called before every call and is not measured,
+    // the counts of the measured calls are added to totals if counters are given
+    template <class Function, class Prepare>
+    [[nodiscard]] std::vector<double> measure(const std::size_t iterations,
+                                              const Function& function,
+                                              const Prepare& prepare,
+                                              const sr::PerformanceCounters* counters = nullptr,
+                                              sr::PerformanceCounters::Values* totals = nullptr)
+    {
+        using Clock = std::chrono::steady_clock;
+
+        prepare();
+        function();
+
+        std::vector<double> times;
+        times.reserve(iterations);
+
+        if (totals)
+        {
+            *totals = sr::PerformanceCounters::Values{};
+            totals->valid.fill(counters != nullptr);
+        }
+
+        for (std::size_t i = 0; i < iterations; ++i)
+        {
+            prepare();
+
+            const auto before = (counters && totals) ? counters->read() : sr::PerformanceCounters::Values{};
+            const auto start = Clock::now();
+            function();
+            const std::chrono::duration<double, std::milli> time = Clock::now() - start;
+            if (counters && totals) *totals += counters->read() - before;
+
+            times.push_back(time.count());
+        }
+
+        return times;
+    }
+
+    template <class Function>
+    [[nodiscard]] std::vector<double> measure(const std::size_t iterations, const Function& function)
+    {
+        return measure(iterations, function, []() {});
+    }
+
+    // the counters per call (frame or operation) next to the times, only the ones the platform provided
+    inline void addCounters(std::vector<std::pair<std::string, double>>& metrics,
+                            const sr::PerformanceCounters::Values& totals,
+                            const double calls,
+                            const std::string& suffix)
+    {
+        using Event = sr::PerformanceCounters::Event;
+
+        for (std::size_t i = 0; i < sr::PerformanceCounters::eventCount; ++i)
+        {
+            const auto event = static_cast<Event>(i);
+            if (totals.isValid(event))
+                metrics.emplace_back(sr::PerformanceCounters::getName(event) + suffix, static_cast<double>(totals[event]) / calls);
+        }
+
+        if (totals.isValid(Event::cycles) && totals.isValid(Event::instructions) && totals[Event::cycles] > 0)
+            metrics.emplace_back("instructionsPerCycle",
+                                 static_cast<double>(totals[Event::instructions]) / static_cast<double>(totals[Event::cycles]));
+    }
+
+    // collects the results and writes them as JSON
+    class Report final
+    {
+    public:
+        using Metrics = std::vector<std::pair<std::string, double>>;
+
+        void add(const std::string& name, const Statistics& statistics, const Metrics& metrics)
+        {
+            entries.push_back(Entry{name, statistics, metrics});
+        }
+
+        void write(std::ostream& stream) const
+        {
+            stream << "{\n  \"benchmarks\": [";
+
+            for (std::size_t i = 0; i < entries.size(); ++i)
+            {
+                const auto& entry = entries[i];
+                const auto& statistics = entry.statistics;
+
+                stream << (i ? ",\n" : "\n") <<
+                    "    {\"name\": \"" << entry.name << "\"" <<
+                    ", \"samples\": " << statistics.samples <<
+                    ", \"outliers\": " << statistics.outliers <<
+                    ", \"time\": {\"min\": " << statistics.min <<
+                    ", \"mean\": " << statistics.mean <<
+                    ", \"median\": " << statistics.median <<
+                    ", \"p90\": " << statistics.p90 <<
+                    ", \"p99\": " << statistics.p99 <<
+                    ", \"max\": " << statistics.max << "}";
+
+                for (const auto& [metric, value] : entry.metrics)
+                    stream << ", \"" << metric << "\": " << (std::isfinite(value) ? value : 0.0);
+
+                stream << "}";
+            }
+
+            stream << "\n  ]\n}\n";
+        }
+
+    private:
+        class Entry final
+        {
+        public:
+            std::string name;
+            Statistics statistics;
+            Metrics metrics;
+        };
+
+        std::vector<Entry> entries;
+    };
+
+    [[nodiscard]] inline bool isEnabled(const Options& options, const std::string& name)
+    {
+        return options.filter.empty() || name.find(options.filter) != std::string::npos;
+    }
+
+    void runSceneBenchmarks(const Options& options, Report& report);
+    void runKernelBenchmarks(const Options& options, Report& report);
+}
+
+#endif
@@ -0,0 +1,300 @@
+//
+//  SoftwareRenderer
+//
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "Benchmark.hpp"
+#include "sr.hpp"
+
+namespace bench
+{
+    namespace
+    {
+        // operations per measured batch
+        constexpr std::size_t batchSize = 4096;
+
+        // larger than the last level cache of the usual desktop and server CPUs
+        constexpr std::size_t flushSize = 64 * 1024 * 1024;
+
+        class CacheFlusher final
+        {
+        public:
+            void flush()
+            {
+                for (std::size_t i = 0; i < buffer.size(); i += 64)
+                    ++buffer[i];
+                keep(buffer[0]);
+            }
+
+        private:
+            std::vector<std::uint8_t> buffer = std::vector<std::uint8_t>(flushSize);
+        };
+
+        class Random final
+        {
+        public:
+            // uniform in [min, max)
+            float next(const float min, const float max) noexcept
+            {
+                state = state * 1664525U + 1013904223U;
+                return min + static_cast<float>(state >> 8) / static_cast<float>(1U << 24) * (max - min);
+            }
+
+        private:
+            std::uint32_t state = 1;
+        };
+
+        const char* getName(const sr::PixelFormat pixelFormat)
+        {
+            switch (pixelFormat)
+            {
+                case sr::PixelFormat::r8: return "r8";
+                case sr::PixelFormat::a8: return "a8";
+                case sr::PixelFormat::rgba8: return "rgba8";
+                case sr::PixelFormat::float32: return "float32";
+                default: return "unknown";
+            }
+        }
+
+        const char* getName(const sr::Sampler::AddressMode addressMode)
+        {
+            switch (addressMode)
+            {
+                case sr::Sampler::AddressMode::clamp: return "clamp";
+                case sr::Sampler::AddressMode::repeat: return "repeat";
+                case sr::Sampler::AddressMode::mirror: return "mirror";
+                default: return "unknown";
+            }
+        }
+
+        sr::Texture createTexture(const sr::PixelFormat pixelFormat, const std::size_t size)
+        {
+            sr::Texture texture{pixelFormat, size, size};
+
+            std::vector<std::uint8_t> data(size * size * sr::getPixelSize(pixelFormat));
+            if (pixelFormat == sr::PixelFormat::float32)
+            {
+                auto values = reinterpret_cast<float*>(data.data());
+                for (std::size_t i = 0; i < size * size; ++i)
+                    values[i] = static_cast<float>(i % 251) / 251.0F;
+            }
+            else
+                for (std::size_t i = 0; i < data.size(); ++i)
+                    data[i] = static_cast<std::uint8_t>(i * 7);
+
+            texture.setData(data, 0);
+            return texture;
+        }
+
+        // warm runs the batch over data that fits in the caches, cold over data that does not and flushes the caches first
+        class Runner final
+        {
+        public:
+            Runner(const Options& initOptions, Report& initReport):
+                options{initOptions}, report{initReport}
+            {
+            }
+
+            template <class Function>
+            void run(const std::string& name, const std::size_t operations, const bool cold, const Function& function)
+            {
+                const auto fullName = "kernels/" + name + (cold ? "/cold" : "/warm");
+                if (!isEnabled(options, fullName)) return;
+
+                // the flushes are not counted
+                sr::PerformanceCounters::Values totals;
+                const auto statistics = getStatistics(measure(options.repetitions, function, [this, cold]() {
+                    if (cold) flusher.flush();
+                }, options.counters ? &counters : nullptr, &totals), true);
+
+                Report::Metrics metrics{
+                    {"operations", static_cast<double>(operations)},
+                    {"nsPerOperation", statistics.median * 1000000.0 / static_cast<double>(operations)}
+                };
+                addCounters(metrics, totals, static_cast<double>(options.repetitions * operations), "PerOperation");
+
+                report.add(fullName, statistics, metrics);
+            }
+
+        private:
+            const Options& options;
+            Report& report;
+            CacheFlusher flusher;
+            const sr::PerformanceCounters counters;
+        };
+
+        void runTextureBenchmarks(Runner& runner)
+        {
+            Random random;
+
+            // coordinates outside of [0, 1] exercise the address modes
+            std::vector<sr::Vector<float, 2>> coordinates(batchSize);
+            for (auto& coordinate : coordinates)
+                coordinate = sr::Vector<float, 2>{random.next(-1.0F, 2.0F), random.next(-1.0F, 2.0F)};
+
+            for (const auto cold : {false, true})
+            {
+                const std::size_t size = cold ? 2048 : 64;
+
+                for (const auto pixelFormat : {sr::PixelFormat::r8, sr::PixelFormat::a8, sr::PixelFormat::rgba8, sr::PixelFormat::float32})
+                {
+                    const auto texture = createTexture(pixelFormat, size);
+
+                    for (const auto filter : {sr::Sampler::Filter::point, sr::Sampler::Filter::linear})
+                        for (const auto addressMode : {sr::Sampler::AddressMode::clamp, sr::Sampler::AddressMode::repeat, sr::Sampler::AddressMode::mirror})
+                        {
+                            sr::Sampler sampler;
+                            sampler.filter = filter;
+                            sampler.addressModeX = addressMode;
+                            sampler.addressModeY = addressMode;
+
+                            const auto name = std::string{"texture/sample/"} + getName(pixelFormat) + "/" +
+                                (filter == sr::Sampler::Filter::point ? "point" : "linear") + "/" + getName(addressMode);
+
+                            runner.run(name, batchSize, cold, [&]() {
+                                for (const auto& coordinate : coordinates)
+                                    keep(texture.sample(&sampler, coordinate));
+                            });
+                        }
+
+                    std::vector<std::pair<std::size_t, std::size_t>> pixels(batchSize);
+                    for (auto& [x, y] : pixels)
+                    {
+                        x = static_cast<std::size_t>(random.next(0.0F, static_cast<float>(size)));
+                        y = static_cast<std::size_t>(random.next(0.0F, static_cast<float>(size)));
+                    }
+
+                    runner.run(std::string{"texture/getPixel/"} + getName(pixelFormat), batchSize, cold, [&]() {
+                        for (const auto& [x, y] : pixels)
+                            keep(texture.getPixel(x, y, 0));
+                    });
+                }
+
+                const std::size_t width = cold ? 1920 : 128;
+                const std::size_t height = cold ? 1080 : 64;
+
+                sr::Texture colorBuffer{sr::PixelFormat::rgba8, width, height};
+                runner.run("texture/clear/color", width * height, cold, [&]() {
+                    clear(colorBuffer, sr::Color{0xFF8040FFU});
+                    keep(colorBuffer.getData()[0]);
+                });
+
+                sr::Texture depthBuffer{sr::PixelFormat::float32, width, height};
+                runner.run("texture/clear/depth", width * height, cold, [&]() {
+                    clear(depthBuffer, 1.0F);
+                    keep(depthBuffer.getData()[0]);
+                });
+            }
+        }
+
+        void runMathBenchmarks(Runner& runner)
+        {
+            Random random;
+
+            for (const auto cold : {false, true})
+            {
+                // the cold variants work on arrays that do not fit in the caches
+                const std::size_t count = cold ? 1024 * 1024 : 256;
+
+                std::vector<sr::Matrix<float, 4>> matrices(count);
+                for (auto& matrix : matrices)
+                    for (auto& value : matrix.m)
+                        value = random.next(-1.0F, 1.0F);
+
+                std::vector<sr::Matrix<float, 4>> results(count);
+
+                runner.run("matrix/multiply", count, cold, [&]() {
+                    for (std::size_t i = 0; i < count; ++i)
+                        results[i] = matrices[i] * matrices[count - 1 - i];
+                    keep(results[0]);
+                });
+
+                runner.run("matrix/invert", count, cold, [&]() {
+                    for (std::size_t i = 0; i < count; ++i)
+                        matrices[i].invert(results[i]);
+                    keep(results[0]);
+                });
+
+                std::vector<sr::Vector<float, 3>> vectors(count);
+                for (auto& vector : vectors)
+                    vector = sr::Vector<float, 3>{random.next(-1.0F, 1.0F), random.next(-1.0F, 1.0F), random.next(-1.0F, 1.0F)};
+
+                runner.run("vector/normalize", count, cold, [&]() {
+                    for (auto vector : vectors)
+                    {
+                        vector.normalize();
+                        keep(vector);
+                    }
+                });
+            }
+        }
+
+        void runBlendBenchmarks(Runner& runner)
+        {
+            Random random;
+
+            std::vector<sr::Color> colors(batchSize);
+            std::vector<std::uint32_t> pixels(batchSize);
+            for (std::size_t i = 0; i < batchSize; ++i)
+            {
+                colors[i] = sr::Color{random.next(0.0F, 1.0F), random.next(0.0F, 1.0F), random.next(0.0F, 1.0F), random.next(0.0F, 1.0F)};
+                pixels[i] = static_cast<std::uint32_t>(random.next(0.0F, 1.0F) * 4294967295.0F);
+            }
+
+            const sr::BlendState::Factor factors[] = {
+                sr::BlendState::Factor::zero, sr::BlendState::Factor::one,
+                sr::BlendState::Factor::srcColor, sr::BlendState::Factor::invSrcColor,
+                sr::BlendState::Factor::srcAlpha, sr::BlendState::Factor::invSrcAlpha,
+                sr::BlendState::Factor::destAlpha, sr::BlendState::Factor::invDestAlpha,
+                sr::BlendState::Factor::destColor, sr::BlendState::Factor::invDestColor,
+                sr::BlendState::Factor::srcAlphaSat,
+                sr::BlendState::Factor::blendFactor, sr::BlendState::Factor::invBlendFactor
+            };
+
+            runner.run("blend/factor", batchSize, false, [&]() {
+                for (std::size_t i = 0; i < batchSize; ++i)
+                {
+                    const auto& color = colors[i];
+                    keep(sr::getValue(factors[i % std::size(factors)], color.r, color.a, color.g, color.b, 0.5F));
+                }
+            });
+
+            const sr::BlendState::Operation operations[] = {
+                sr::BlendState::Operation::add, sr::BlendState::Operation::subtract,
+                sr::BlendState::Operation::reverseSubtract,
+                sr::BlendState::Operation::min, sr::BlendState::Operation::max
+            };
+
+            runner.run("blend/operation", batchSize, false, [&]() {
+                for (std::size_t i = 0; i < batchSize; ++i)
+                {
+                    const auto& color = colors[i];
+                    keep(sr::getValue(operations[i % std::size(operations)], color.r, color.g));
+                }
+            });
+
+            // the alpha blending of the demo applied to whole pixels
+            sr::BlendState blendState;
+            blendState.enabled = true;
+            blendState.colorBlendSource = sr::BlendState::Factor::srcAlpha;
+            blendState.colorBlendDest = sr::BlendState::Factor::invSrcAlpha;
+            blendState.alphaBlendSource = sr::BlendState::Factor::one;
+            blendState.alphaBlendDest = sr::BlendState::Factor::one;
+
+            runner.run("blend/pixel", batchSize, false, [&]() {
+                for (std::size_t i = 0; i < batchSize; ++i)
+                    keep(sr::detail::blend(blendState, colors[i], pixels[i]));
+            });
+        }
+    }
+
+    void runKernelBenchmarks(const Options& options, Report& report)
+    {
+        Runner runner{options, report};
+        runTextureBenchmarks(runner);
+        runMathBenchmarks(runner);
+        runBlendBenchmarks(runner);
+    }
+}
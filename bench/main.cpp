@@ -0,0 +1,59 @@
+//
+//  SoftwareRenderer
+//
+
+#include <cstdlib>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include "Benchmark.hpp"
+
+int main(int argc, char* argv[])
+{
+    try
+    {
+        bench::Options options;
+
+        for (int i = 1; i < argc; ++i)
+        {
+            const std::string argument{argv[i]};
+
+            if (i + 1 >= argc)
+                throw std::runtime_error{"Missing value for " + argument};
+
+            const std::string value{argv[++i]};
+
+            if (argument == "--filter")
+                options.filter = value;
+            else if (argument == "--suite")
+                options.suite = value;
+            else if (argument == "--iterations")
+                options.iterations = std::stoul(value);
+            else if (argument == "--repetitions")
+                options.repetitions = std::stoul(value);
+            else if (argument == "--counters")
+            {
+                if (value == "on") options.counters = true;
+                else if (value == "off") options.counters = false;
+                else throw std::runtime_error{"Invalid counters " + value};
+            }
+            else
+                throw std::runtime_error{"Invalid argument " + argument};
+        }
+
+        bench::Report report;
+        if (options.suite != "all" && options.suite != "scenes" && options.suite != "kernels")
+            throw std::runtime_error{"Invalid suite " + options.suite};
+
+        if (options.suite != "kernels") bench::runSceneBenchmarks(options, report);
+        if (options.suite != "scenes") bench::runKernelBenchmarks(options, report);
+        report.write(std::cout);
+
+        return EXIT_SUCCESS;
+    }
+    catch (const std::exception& e)
+    {
+        std::cerr << e.what() << std::endl;
+        return EXIT_FAILURE;
+    }
+}
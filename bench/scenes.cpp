@@ -0,0 +1,481 @@
+//
+//  SoftwareRenderer
+//
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <string>
+#include <tuple>
+#include <vector>
+#include "Benchmark.hpp"
+#include "sr.hpp"
+
+namespace bench
+{
+    namespace
+    {
+        sr::VertexShaderOutput vertexShader(const sr::Matrix<float, 4>& modelViewProjection,
+                                            const sr::Vertex& vertex,
+                                            const sr::Instance& instance,
+                                            const sr::ConstantBuffer&)
+        {
+            sr::VertexShaderOutput result;
+            result.position = modelViewProjection * vertex.position;
+            result.color = sr::Color{vertex.color.r * instance.color.r,
+                                     vertex.color.g * instance.color.g,
+                                     vertex.color.b * instance.color.b,
+                                     vertex.color.a * instance.color.a};
+            result.texCoords[0] = vertex.texCoords[0];
+            result.texCoords[1] = vertex.texCoords[1];
+            result.normal = vertex.normal;
+            return result;
+        }
+
+        sr::Color colorShader(const sr::VertexShaderOutput& input,
+                              const std::array<const sr::Sampler*, 2>&,
+                              const std::array<sr::TextureView, 2>&,
+                              const sr::ConstantBuffer&)
+        {
+            return input.color;
+        }
+
+        sr::Color textureShader(const sr::VertexShaderOutput& input,
+                                const std::array<const sr::Sampler*, 2>& samplers,
+                                const std::array<sr::TextureView, 2>& textures,
+                                const sr::ConstantBuffer&)
+        {
+            const auto sampleColor = textures[0].sample(samplers[0], input.texCoords[0]);
+
+            return sr::Color{
+                input.color.r * sampleColor.r,
+                input.color.g * sampleColor.g,
+                input.color.b * sampleColor.b,
+                input.color.a * sampleColor.a
+            };
+        }
+
+        // counts the fragments of the calibration frame
+        sr::FragmentShader* countedShader = nullptr;
+        std::size_t fragmentCount = 0;
+
+        sr::Color countingShader(const sr::VertexShaderOutput& input,
+                                 const std::array<const sr::Sampler*, 2>& samplers,
+                                 const std::array<sr::TextureView, 2>& textures,
+                                 const sr::ConstantBuffer& constants)
+        {
+            ++fragmentCount;
+            return countedShader(input, samplers, textures, constants);
+        }
+
+        class Scene final
+        {
+        public:
+            void addDraw(std::vector<std::uint32_t> indices,
+                         std::vector<sr::Vertex> vertices,
+                         const sr::Matrix<float, 4>& modelViewProjection = sr::Matrix<float, 4>::identity(),
+                         std::vector<sr::Instance> instances = {})
+            {
+                triangleCount += indices.size() / 3 * (instances.empty() ? 1 : instances.size());
+
+                // deques keep the buffers in place while the draw calls point to them
+                indexBuffers.push_back(std::move(indices));
+                vertexBuffers.push_back(std::move(vertices));
+                instanceBuffers.push_back(std::move(instances));
+
+                sr::DrawCall drawCall;
+                drawCall.vertexShader = vertexShader;
+                drawCall.fragmentShader = fragmentShader;
+                drawCall.fragmentShaderInputs = fragmentShaderInputs;
+                drawCall.samplers = {&sampler, nullptr};
+                drawCall.textures = {sr::TextureView{texture}, sr::TextureView{}};
+                drawCall.viewport = sr::Rect<float>{0.0F, 0.0F, static_cast<float>(width), static_cast<float>(height)};
+                drawCall.blendState = blendState;
+                drawCall.depthState = depthState;
+                drawCall.cullMode = cullMode;
+                drawCall.indices = indexBuffers.back();
+                drawCall.vertices = &vertexBuffers.back();
+                drawCall.instances = instanceBuffers.back().empty() ? nullptr : &instanceBuffers.back();
+                drawCall.modelViewProjection = modelViewProjection;
+                drawCalls.push_back(drawCall);
+            }
+
+            // full screen quad in normalized device coordinates
+            void addQuad(const float z, const sr::Color color)
+            {
+                addDraw({0, 1, 2, 1, 3, 2}, {
+                    sr::Vertex{sr::Vector<float, 4>{-1.0F, -1.0F, z, 1.0F}, color, sr::Vector<float, 2>{0.0F, 0.0F}, sr::Vector<float, 3>{}},
+                    sr::Vertex{sr::Vector<float, 4>{-1.0F, 1.0F, z, 1.0F}, color, sr::Vector<float, 2>{0.0F, 1.0F}, sr::Vector<float, 3>{}},
+                    sr::Vertex{sr::Vector<float, 4>{1.0F, -1.0F, z, 1.0F}, color, sr::Vector<float, 2>{1.0F, 0.0F}, sr::Vector<float, 3>{}},
+                    sr::Vertex{sr::Vector<float, 4>{1.0F, 1.0F, z, 1.0F}, color, sr::Vector<float, 2>{1.0F, 1.0F}, sr::Vector<float, 3>{}}
+                });
+            }
+
+            std::size_t width = 0;
+            std::size_t height = 0;
+            sr::FragmentShader* fragmentShader = colorShader;
+            std::uint32_t fragmentShaderInputs = sr::getMask(sr::Varying::color);
+            sr::BlendState blendState;
+            sr::DepthState depthState;
+            sr::CullMode cullMode = sr::CullMode::none;
+            sr::OcclusionBuffer occlusionBuffer;
+            sr::Sampler sampler;
+            sr::Texture texture;
+
+            std::deque<std::vector<std::uint32_t>> indexBuffers;
+            std::deque<std::vector<sr::Vertex>> vertexBuffers;
+            std::deque<std::vector<sr::Instance>> instanceBuffers;
+            std::deque<std::vector<sr::Cluster>> clusterBuffers;
+            std::vector<sr::DrawCall> drawCalls;
+            std::size_t triangleCount = 0;
+        };
+
+        // opaque full screen quads drawn back to front, every layer is shaded
+        void setupOverdraw(Scene& scene, const std::size_t layers)
+        {
+            for (std::size_t layer = 0; layer < layers; ++layer)
+                scene.addQuad(0.9F - 0.8F * static_cast<float>(layer) / static_cast<float>(layers),
+                              sr::Color{static_cast<std::uint32_t>(0x10204000U + layer * 0x00100000U) | 0xFFU});
+        }
+
+        // a grid of triangles covering the screen, each of them a couple of pixels large
+        void setupSmallTriangles(Scene& scene, const std::size_t cellSize)
+        {
+            const auto columns = scene.width / cellSize;
+            const auto rows = scene.height / cellSize;
+
+            std::vector<std::uint32_t> indices;
+            std::vector<sr::Vertex> vertices;
+
+            for (std::size_t row = 0; row <= rows; ++row)
+                for (std::size_t column = 0; column <= columns; ++column)
+                {
+                    const auto x = static_cast<float>(column) / static_cast<float>(columns) * 2.0F - 1.0F;
+                    const auto y = static_cast<float>(row) / static_cast<float>(rows) * 2.0F - 1.0F;
+                    vertices.push_back(sr::Vertex{sr::Vector<float, 4>{x, y, 0.5F, 1.0F},
+                                                  sr::Color{static_cast<std::uint32_t>(row * 0x01030500U + column * 0x05030100U) | 0xFFU},
+                                                  sr::Vector<float, 2>{}, sr::Vector<float, 3>{}});
+                }
+
+            for (std::size_t row = 0; row < rows; ++row)
+                for (std::size_t column = 0; column < columns; ++column)
+                {
+                    const auto i = static_cast<std::uint32_t>(row * (columns + 1) + column);
+                    const auto stride = static_cast<std::uint32_t>(columns + 1);
+                    indices.insert(indices.end(), {i, i + stride, i + 1, i + stride, i + stride + 1, i + 1});
+                }
+
+            scene.addDraw(std::move(indices), std::move(vertices));
+        }
+
+        // the textured and partially transparent box of the demo
+        void setupCube(Scene& scene)
+        {
+            constexpr std::size_t textureSize = 256;
+            std::vector<std::uint8_t> pixels(textureSize * textureSize * 4);
+            for (std::size_t y = 0; y < textureSize; ++y)
+                for (std::size_t x = 0; x < textureSize; ++x)
+                {
+                    const auto value = static_cast<std::uint8_t>((((x / 32) + (y / 32)) % 2) ? 255 : 64);
+                    const auto pixel = &pixels[(y * textureSize + x) * 4];
+                    pixel[0] = value;
+                    pixel[1] = value;
+                    pixel[2] = value;
+                    pixel[3] = 255;
+                }
+
+            scene.texture = sr::Texture{sr::PixelFormat::rgba8, textureSize, textureSize};
+            scene.texture.setData(pixels, 0);
+            scene.sampler.addressModeX = sr::Sampler::AddressMode::repeat;
+            scene.sampler.addressModeY = sr::Sampler::AddressMode::repeat;
+            scene.sampler.filter = sr::Sampler::Filter::linear;
+            scene.fragmentShader = textureShader;
+            scene.fragmentShaderInputs = sr::getMask(sr::Varying::color) | sr::getMask(sr::Varying::texCoord0);
+
+            scene.blendState.enabled = true;
+            scene.blendState.colorBlendSource = sr::BlendState::Factor::srcAlpha;
+            scene.blendState.colorBlendDest = sr::BlendState::Factor::invSrcAlpha;
+
+            const auto vertex = [](const float x, const float y, const float z,
+                                   const std::uint32_t color, const float u, const float v) {
+                return sr::Vertex{sr::Vector<float, 4>{x, y, z, 1.0F}, sr::Color{color},
+                                  sr::Vector<float, 2>{u, v}, sr::Vector<float, 3>{0.0F, 0.0F, 1.0F}};
+            };
+
+            sr::Matrix<float, 4> projection;
+            projection.setPerspective(sr::tau<float> / 6.0F,
+                                      static_cast<float>(scene.width) / static_cast<float>(scene.height),
+                                      1.0F, 1000.0F);
+            sr::Matrix<float, 4> view;
+            view.setTranslation(0.0F, 0.0F, 50.0F);
+            sr::Matrix<float, 4> model;
+            model.setRotationY(0.5F);
+
+            scene.addDraw({
+                0, 1, 2, 1, 3, 2,
+                4, 5, 6, 5, 7, 6,
+                16, 17, 18, 17, 19, 18,
+                20, 21, 22, 21, 23, 22,
+                8, 9, 10, 9, 11, 10,
+                12, 13, 14, 13, 15, 14
+            }, {
+                vertex(-20.0F, -20.0F, -20.0F, 0xFF0000FFU, 0.0F, 0.0F), vertex(-20.0F, 20.0F, -20.0F, 0x00FF00FFU, 0.0F, 1.0F),
+                vertex(20.0F, -20.0F, -20.0F, 0x0000FFFFU, 1.0F, 0.0F), vertex(20.0F, 20.0F, -20.0F, 0xFFFFFFFFU, 1.0F, 1.0F),
+                vertex(-20.0F, -20.0F, 20.0F, 0xFFFFFFFFU, 0.0F, 0.0F), vertex(-20.0F, 20.0F, 20.0F, 0xFFFFFFFFU, 0.0F, 1.0F),
+                vertex(20.0F, -20.0F, 20.0F, 0xFFFFFFFFU, 1.0F, 0.0F), vertex(20.0F, 20.0F, 20.0F, 0xFFFFFFFFU, 1.0F, 1.0F),
+                vertex(-20.0F, -20.0F, -20.0F, 0xFFFFFFFFU, 0.0F, 0.0F), vertex(-20.0F, 20.0F, -20.0F, 0xFFFFFFFFU, 0.0F, 4.0F),
+                vertex(-20.0F, -20.0F, 20.0F, 0xFFFFFFFFU, 4.0F, 0.0F), vertex(-20.0F, 20.0F, 20.0F, 0xFFFFFFFFU, 4.0F, 4.0F),
+                vertex(20.0F, -20.0F, -20.0F, 0xFFFFFFA0U, 0.0F, 0.0F), vertex(20.0F, 20.0F, -20.0F, 0xFFFFFFA0U, 0.0F, 1.0F),
+                vertex(20.0F, -20.0F, 20.0F, 0xFFFFFFA0U, 1.0F, 0.0F), vertex(20.0F, 20.0F, 20.0F, 0xFFFFFFA0U, 1.0F, 1.0F),
+                vertex(-20.0F, -20.0F, -20.0F, 0xFFFFFFFFU, 0.0F, 0.0F), vertex(-20.0F, -20.0F, 20.0F, 0xFFFFFFFFU, 0.0F, 1.0F),
+                vertex(20.0F, -20.0F, -20.0F, 0xFFFFFFFFU, 1.0F, 0.0F), vertex(20.0F, -20.0F, 20.0F, 0xFFFFFFFFU, 1.0F, 1.0F),
+                vertex(-20.0F, 20.0F, -20.0F, 0xFFFFFFFFU, 0.0F, 0.0F), vertex(-20.0F, 20.0F, 20.0F, 0xFFFFFFFFU, 0.0F, 1.0F),
+                vertex(20.0F, 20.0F, -20.0F, 0xFFFFFFFFU, 1.0F, 0.0F), vertex(20.0F, 20.0F, 20.0F, 0xFFFFFFFFU, 1.0F, 1.0F)
+            }, projection * view * model);
+        }
+
+        // translucent full screen layers
+        void setupBlendLayers(Scene& scene, const std::size_t layers)
+        {
+            scene.depthState.read = false;
+            scene.depthState.write = false;
+            scene.blendState.enabled = true;
+            scene.blendState.colorBlendSource = sr::BlendState::Factor::srcAlpha;
+            scene.blendState.colorBlendDest = sr::BlendState::Factor::invSrcAlpha;
+
+            for (std::size_t layer = 0; layer < layers; ++layer)
+                scene.addQuad(0.5F, sr::Color{static_cast<std::uint32_t>(0x20406000U + layer * 0x10000000U) | 0x80U});
+        }
+
+        // full screen quads of which most fail the depth test (front to back) or all pass it (back to front)
+        void setupDepthLayers(Scene& scene, const std::size_t layers, const bool frontToBack)
+        {
+            for (std::size_t layer = 0; layer < layers; ++layer)
+            {
+                const auto position = static_cast<float>(frontToBack ? layer : layers - 1 - layer) / static_cast<float>(layers);
+                scene.addQuad(0.1F + 0.8F * position,
+                              sr::Color{static_cast<std::uint32_t>(0x40200000U + layer * 0x00081000U) | 0xFFU});
+            }
+        }
+
+        // a small mesh drawn many times with a single instanced draw, like foliage or crowds
+        void setupInstances(Scene& scene, const std::size_t columns, const std::size_t rows)
+        {
+            std::vector<sr::Instance> instances;
+
+            for (std::size_t row = 0; row < rows; ++row)
+                for (std::size_t column = 0; column < columns; ++column)
+                {
+                    sr::Matrix<float, 4> scale;
+                    scale.setScale(1.0F / static_cast<float>(columns), 1.0F / static_cast<float>(rows), 1.0F);
+                    sr::Matrix<float, 4> translation;
+                    translation.setTranslation((static_cast<float>(column) + 0.5F) / static_cast<float>(columns) * 2.0F - 1.0F,
+                                               (static_cast<float>(row) + 0.5F) / static_cast<float>(rows) * 2.0F - 1.0F,
+                                               0.0F);
+
+                    sr::Instance instance;
+                    instance.transform = translation * scale;
+                    instance.color = sr::Color{static_cast<std::uint32_t>(row * 0x01030500U + column * 0x05030100U) | 0xFFU};
+                    instances.push_back(instance);
+                }
+
+            // a diamond with a center vertex
+            scene.addDraw({0, 1, 4, 1, 2, 4, 2, 3, 4, 3, 0, 4}, {
+                sr::Vertex{sr::Vector<float, 4>{-1.0F, 0.0F, 0.5F, 1.0F}, sr::Color{0xFFFFFFFFU}, sr::Vector<float, 2>{}, sr::Vector<float, 3>{}},
+                sr::Vertex{sr::Vector<float, 4>{0.0F, 1.0F, 0.5F, 1.0F}, sr::Color{0xFFFFFFFFU}, sr::Vector<float, 2>{}, sr::Vector<float, 3>{}},
+                sr::Vertex{sr::Vector<float, 4>{1.0F, 0.0F, 0.5F, 1.0F}, sr::Color{0xFFFFFFFFU}, sr::Vector<float, 2>{}, sr::Vector<float, 3>{}},
+                sr::Vertex{sr::Vector<float, 4>{0.0F, -1.0F, 0.5F, 1.0F}, sr::Color{0xFFFFFFFFU}, sr::Vector<float, 2>{}, sr::Vector<float, 3>{}},
+                sr::Vertex{sr::Vector<float, 4>{0.0F, 0.0F, 0.4F, 1.0F}, sr::Color{0x808080FFU}, sr::Vector<float, 2>{}, sr::Vector<float, 3>{}}
+            }, sr::Matrix<float, 4>::identity(), std::move(instances));
+        }
+
+        // a finely tessellated sphere close to the camera, half of it facing away and a part of it outside of the view
+        void setupSphere(Scene& scene, const bool clusters)
+        {
+            constexpr std::size_t segments = 256;
+            constexpr std::size_t rings = 128;
+
+            std::vector<sr::Vertex> vertices;
+            for (std::size_t ring = 0; ring <= rings; ++ring)
+                for (std::size_t segment = 0; segment <= segments; ++segment)
+                {
+                    const auto latitude = static_cast<float>(ring) / static_cast<float>(rings) * sr::tau<float> / 2.0F;
+                    const auto longitude = static_cast<float>(segment) / static_cast<float>(segments) * sr::tau<float>;
+                    const sr::Vector<float, 3> normal{
+                        std::sin(latitude) * std::cos(longitude),
+                        std::cos(latitude),
+                        std::sin(latitude) * std::sin(longitude)
+                    };
+                    vertices.push_back(sr::Vertex{sr::Vector<float, 4>{normal.v[0], normal.v[1], normal.v[2], 1.0F},
+                                                  sr::Color{static_cast<std::uint32_t>(ring * 0x02000000U + segment * 0x00010100U) | 0xFFU},
+                                                  sr::Vector<float, 2>{}, normal});
+                }
+
+            std::vector<std::uint32_t> indices;
+            for (std::size_t ring = 0; ring < rings; ++ring)
+                for (std::size_t segment = 0; segment < segments; ++segment)
+                {
+                    const auto i = static_cast<std::uint32_t>(ring * (segments + 1) + segment);
+                    const auto next = static_cast<std::uint32_t>(i + segments + 1);
+                    indices.insert(indices.end(), {i, next, i + 1, i + 1, next, next + 1});
+                }
+
+            sr::Matrix<float, 4> projection;
+            projection.setPerspective(sr::tau<float> / 6.0F,
+                                      static_cast<float>(scene.width) / static_cast<float>(scene.height),
+                                      1.0F, 1000.0F);
+            sr::Matrix<float, 4> view;
+            view.setTranslation(0.8F, 0.0F, 2.5F);
+
+            scene.cullMode = sr::CullMode::back;
+            if (clusters) scene.clusterBuffers.push_back(sr::buildClusters(indices, vertices));
+            scene.addDraw(std::move(indices), std::move(vertices), projection * view);
+            if (clusters) scene.drawCalls.back().clusters = &scene.clusterBuffers.back();
+        }
+
+        // the instanced grid with its lower part behind a wall, like buildings hiding the objects of a street
+        void setupOccludedInstances(Scene& scene, const bool occlusion)
+        {
+            const std::vector<std::uint32_t> wallIndices{0, 1, 2, 1, 3, 2};
+            const std::vector<sr::Vertex> wallVertices{
+                sr::Vertex{sr::Vector<float, 4>{-1.0F, -1.0F, 0.2F, 1.0F}, sr::Color{0x404040FFU}, sr::Vector<float, 2>{}, sr::Vector<float, 3>{}},
+                sr::Vertex{sr::Vector<float, 4>{-1.0F, 0.5F, 0.2F, 1.0F}, sr::Color{0x404040FFU}, sr::Vector<float, 2>{}, sr::Vector<float, 3>{}},
+                sr::Vertex{sr::Vector<float, 4>{1.0F, -1.0F, 0.2F, 1.0F}, sr::Color{0x404040FFU}, sr::Vector<float, 2>{}, sr::Vector<float, 3>{}},
+                sr::Vertex{sr::Vector<float, 4>{1.0F, 0.5F, 0.2F, 1.0F}, sr::Color{0x404040FFU}, sr::Vector<float, 2>{}, sr::Vector<float, 3>{}}
+            };
+
+            if (occlusion)
+                scene.occlusionBuffer.drawOccluder(wallIndices, wallVertices, sr::Matrix<float, 4>::identity());
+
+            scene.addDraw(wallIndices, wallVertices);
+            setupInstances(scene, 64, 64);
+
+            auto& drawCall = scene.drawCalls.back();
+            drawCall.bounds = sr::BoundingVolume::box(sr::Vector<float, 3>{-1.0F, -1.0F, 0.4F}, sr::Vector<float, 3>{1.0F, 1.0F, 0.5F});
+            if (occlusion) drawCall.occlusionBuffer = &scene.occlusionBuffer;
+        }
+
+        class Workload final
+        {
+        public:
+            std::string name;
+            void (*setup)(Scene& scene);
+        };
+    }
+
+    void runSceneBenchmarks(const Options& options, Report& report)
+    {
+        const std::vector<Workload> workloads{
+            {"fill/overdraw1", [](Scene& scene) { setupOverdraw(scene, 1); }},
+            {"fill/overdraw4", [](Scene& scene) { setupOverdraw(scene, 4); }},
+            {"fill/overdraw16", [](Scene& scene) { setupOverdraw(scene, 16); }},
+            {"triangles/small", [](Scene& scene) { setupSmallTriangles(scene, 4); }},
+            {"cube/textured", [](Scene& scene) { setupCube(scene); }},
+            {"blend/layers8", [](Scene& scene) { setupBlendLayers(scene, 8); }},
+            {"depth/frontToBack16", [](Scene& scene) { setupDepthLayers(scene, 16, true); }},
+            {"depth/backToFront16", [](Scene& scene) { setupDepthLayers(scene, 16, false); }},
+            {"instances/grid64", [](Scene& scene) { setupInstances(scene, 64, 64); }},
+            {"occlusion/wall", [](Scene& scene) { setupOccludedInstances(scene, false); }},
+            {"occlusion/wallCulled", [](Scene& scene) { setupOccludedInstances(scene, true); }},
+            {"mesh/sphere", [](Scene& scene) { setupSphere(scene, false); }},
+            {"mesh/sphereClusters", [](Scene& scene) { setupSphere(scene, true); }}
+        };
+
+        const std::vector<std::pair<std::size_t, std::size_t>> resolutions{
+            {320, 240},
+            {1280, 720},
+            {1920, 1080}
+        };
+
+        sr::JobSystem jobSystem;
+        const sr::PerformanceCounters counters;
+
+        for (const auto& workload : workloads)
+            for (const auto& [width, height] : resolutions)
+            {
+                const auto baseName = workload.name + "/" + std::to_string(width) + "x" + std::to_string(height);
+                if (!isEnabled(options, baseName)) continue;
+
+                Scene scene;
+                scene.width = width;
+                scene.height = height;
+                scene.depthState.read = true;
+                scene.depthState.write = true;
+                workload.setup(scene);
+
+                sr::Texture colorBuffer{sr::PixelFormat::rgba8, width, height};
+                sr::Texture depthBuffer{sr::PixelFormat::float32, width, height};
+
+                sr::RenderPass renderPass;
+                renderPass.colorAttachment.texture = &colorBuffer;
+                renderPass.colorAttachment.loadAction = sr::RenderPass::LoadAction::clear;
+                renderPass.depthAttachment.texture = &depthBuffer;
+                renderPass.depthAttachment.loadAction = sr::RenderPass::LoadAction::clear;
+
+                // the fragments of a frame are the same in every mode
+                auto countingDrawCalls = scene.drawCalls;
+                for (auto& drawCall : countingDrawCalls)
+                    drawCall.fragmentShader = countingShader;
+                countedShader = scene.fragmentShader;
+                fragmentCount = 0;
+                drawTriangles(renderPass, countingDrawCalls);
+                const auto fragments = fragmentCount;
+
+                const std::vector<std::tuple<std::string, std::size_t, sr::JobSystem*>> modes{
+                    {"immediate", 0, nullptr},
+                    {"tiled", 64, nullptr},
+                    {"tiledParallel", 64, &jobSystem}
+                };
+
+                for (const auto& [mode, tileSize, modeJobSystem] : modes)
+                {
+                    const auto name = baseName + "/" + mode;
+                    if (!isEnabled(options, name)) continue;
+
+                    renderPass.tileSize = tileSize;
+
+                    // only the work of the calling thread is counted, the workers of the parallel mode are not
+                    sr::PerformanceCounters::Values totals;
+                    const auto statistics = getStatistics(measure(options.iterations, [&]() {
+                        drawTriangles(renderPass, scene.drawCalls, modeJobSystem);
+                    }, []() {}, options.counters ? &counters : nullptr, &totals));
+
+                    Report::Metrics metrics{
+                        {"triangles", static_cast<double>(scene.triangleCount)},
+                        {"fragments", static_cast<double>(fragments)},
+                        {"mtrisPerSecond", static_cast<double>(scene.triangleCount) / statistics.median / 1000.0},
+                        {"mpixPerSecond", static_cast<double>(fragments) / statistics.median / 1000.0}
+                    };
+
+                    addCounters(metrics, totals, static_cast<double>(options.iterations), "PerFrame");
+
+                    // the pipeline counters of a frame that is not measured
+                    if constexpr (sr::pipelineStatisticsEnabled)
+                    {
+                        std::vector<sr::PipelineStatistics> drawStatistics;
+                        drawTriangles(renderPass, scene.drawCalls, modeJobSystem, &drawStatistics);
+
+                        sr::PipelineStatistics total;
+                        for (const auto& drawCounters : drawStatistics) total += drawCounters;
+
+                        metrics.insert(metrics.end(), {
+                            {"objectsCulled", static_cast<double>(total.objectsCulled)},
+                            {"clustersCulled", static_cast<double>(total.clustersCulled)},
+                            {"vertexShaderInvocations", static_cast<double>(total.vertexShaderInvocations)},
+                            {"trianglesCulled", static_cast<double>(total.trianglesCulled)},
+                            {"trianglesClipped", static_cast<double>(total.trianglesClipped)},
+                            {"pixelsVisited", static_cast<double>(total.pixelsVisited)},
+                            {"pixelsCovered", static_cast<double>(total.pixelsCovered)},
+                            {"depthTestsPassed", static_cast<double>(total.depthTestsPassed)},
+                            {"depthTestsFailed", static_cast<double>(total.depthTestsFailed)},
+                            {"fragmentShaderInvocations", static_cast<double>(total.fragmentShaderInvocations)},
+                            {"pixelsBlended", static_cast<double>(total.pixelsBlended)}
+                        });
+                    }
+
+                    report.add(name, statistics, metrics);
+                }
+            }
+    }
+}
@@ -13,7 +13,9 @@
 namespace demo
 {
     inline sr::VertexShaderOutput vertexShader(const sr::Matrix<float, 4>& modelViewProjection,
-                                               const sr::Vertex& vertex)
+                                               const sr::Vertex& vertex,
+                                               const sr::Instance&,
+                                               const sr::ConstantBuffer&)
     {
         sr::VertexShaderOutput result;
 
@@ -29,9 +31,10 @@ namespace demo
 
     inline sr::Color fragmentShader(const sr::VertexShaderOutput& input,
                                     const std::array<const sr::Sampler*, 2>& samplers,
-                                    const std::array<const sr::Texture*, 2>& textures)
+                                    const std::array<sr::TextureView, 2>& textures,
+                                    const sr::ConstantBuffer&)
     {
-        const auto sampleColor = textures[0]->sample(samplers[0], input.texCoords[0]);
+        const auto sampleColor = textures[0].sample(samplers[0], input.texCoords[0]);
 
         const sr::Color result{
             input.color.r * sampleColor.r,
@@ -113,6 +116,19 @@ namespace demo
 
             depthState.read = true;
             depthState.write = true;
+
+            // the samples are resolved into the target straight from the tile buffers
+            renderPass.colorAttachment.texture = &multisampleFrameBuffer;
+            renderPass.colorAttachment.loadAction = sr::RenderPass::LoadAction::clear;
+            renderPass.colorAttachment.storeAction = sr::RenderPass::StoreAction::discard;
+            renderPass.colorAttachment.clearColor = sr::Color{255, 255, 255, 255};
+
+            // nobody reads the depth after the frame, so it stays in the tile buffers
+            renderPass.depthAttachment.texture = nullptr;
+            renderPass.depthAttachment.loadAction = sr::RenderPass::LoadAction::clear;
+            renderPass.depthAttachment.storeAction = sr::RenderPass::StoreAction::discard;
+            renderPass.depthAttachment.clearDepth = 1000.0F;
+            renderPass.tileSize = 64;
         }
         virtual ~Application() = default;
 
@@ -127,7 +143,7 @@ namespace demo
             viewport.size.v[1] = static_cast<float>(newHeight);
 
             frameBuffer.resize(newWidth, newHeight);
-            depthBuffer.resize(newWidth, newHeight);
+            multisampleFrameBuffer.resize(newWidth, newHeight);
 
             projection.setPerspective(sr::tau<float> / 6.0,
                                       static_cast<float>(newWidth) / static_cast<float>(newHeight),
@@ -138,27 +154,30 @@ namespace demo
         
         void render()
         {
+            render(sr::TextureView{frameBuffer});
+        }
+
+        // resolves the frame into the target, it must have the size of the frame buffer
+        void render(const sr::TextureView& target)
+        {
+            sr::TraceScope trace{"frame"};
+
             rotationY += 0.05F;
             model.setRotationY(rotationY);
 
-            const auto modelViewProjection = projection * view * model;
-
-            clear(frameBuffer, sr::Color{255, 255, 255, 255});
-            clear(depthBuffer, 1000.0F);
-
-            drawTriangles(frameBuffer,
-                          depthBuffer,
-                          vertexShader,
-                          fragmentShader,
-                          {&sampler, nullptr},
-                          {&texture, nullptr},
-                          viewport,
-                          scissorRect,
-                          blendState,
-                          depthState,
-                          indices,
-                          vertices,
-                          modelViewProjection);
+            commandBuffer.reset();
+            commandBuffer.setShaders(vertexShader, fragmentShader);
+            commandBuffer.setFragmentShaderInputs(sr::getMask(sr::Varying::color) | sr::getMask(sr::Varying::texCoord0));
+            commandBuffer.setSamplers({&sampler, nullptr});
+            commandBuffer.setTextures({sr::TextureView{texture}, sr::TextureView{}});
+            commandBuffer.setViewport(viewport);
+            commandBuffer.setScissorRect(scissorRect);
+            commandBuffer.setBlendState(blendState);
+            commandBuffer.setDepthState(depthState);
+            commandBuffer.drawTriangles(indices, vertices, projection * view * model);
+
+            renderPass.colorAttachment.resolveView = target;
+            execute(renderPass, {&commandBuffer}, true, &jobSystem);
         }
         
         const sr::Texture& getFrameBuffer() const noexcept { return frameBuffer; }
@@ -171,7 +190,7 @@ namespace demo
             viewport.size.v[1] = static_cast<float>(newHeight);
             
             frameBuffer.resize(newWidth, newHeight);
-            depthBuffer.resize(newWidth, newHeight);
+            multisampleFrameBuffer.resize(newWidth, newHeight);
 
             projection.setPerspective(sr::tau<float> / 6.0,
                                       static_cast<float>(newWidth) / static_cast<float>(newHeight),
@@ -185,7 +204,7 @@ namespace demo
         float rotationY = 0.0F;
 
         sr::Texture frameBuffer{sr::PixelFormat::rgba8};
-        sr::Texture depthBuffer{sr::PixelFormat::float32};
+        sr::Texture multisampleFrameBuffer{sr::PixelFormat::rgba8, 0, 0, false, 4};
 
         sr::Rect<float> viewport;
         sr::Rect<float> scissorRect{0.0F, 0.0F, 1.0F, 1.0F};
@@ -195,8 +214,12 @@ namespace demo
         sr::Sampler sampler;
         sr::Texture texture;
 
-        std::vector<std::size_t> indices;
+        std::vector<std::uint16_t> indices;
         std::vector<sr::Vertex> vertices;
+
+        sr::RenderPass renderPass;
+        sr::CommandBuffer commandBuffer;
+        sr::JobSystem jobSystem;
     };
 }
 
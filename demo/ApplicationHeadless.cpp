@@ -0,0 +1,181 @@
+//
+//  SoftwareRenderer
+//
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <memory>
+#include <iostream>
+#include <stdexcept>
+#include <vector>
+#include "ApplicationHeadless.hpp"
+
+namespace demo
+{
+    std::string getResourcePath()
+    {
+        return "Resources";
+    }
+
+    ApplicationHeadless::ApplicationHeadless(const Options& initOptions):
+        options{initOptions}
+    {
+        if (options.width == 0 || options.height == 0)
+            throw std::runtime_error{"Invalid resolution"};
+
+        if (options.frameCount == 0 && options.timeBudget.count() <= 0.0)
+            throw std::runtime_error{"Either a frame count or a time budget is required"};
+
+        setup(options.width, options.height);
+    }
+
+    void ApplicationHeadless::run()
+    {
+        using Clock = std::chrono::steady_clock;
+
+        std::vector<double> frameTimes;
+        const auto start = Clock::now();
+
+        for (std::size_t frame = 0; options.frameCount == 0 || frame < options.frameCount; ++frame)
+        {
+            if (options.timeBudget.count() > 0.0 && Clock::now() - start >= options.timeBudget)
+                break;
+
+            const auto frameStart = Clock::now();
+            render();
+            const std::chrono::duration<double, std::milli> frameTime = Clock::now() - frameStart;
+
+            frameTimes.push_back(frameTime.count());
+            std::cerr << "Frame " << frame << ": " << frameTime.count() << " ms\n";
+
+            write(frame);
+        }
+
+        if (frameTimes.empty()) return;
+
+        std::sort(frameTimes.begin(), frameTimes.end());
+
+        double total = 0.0;
+        for (const auto frameTime : frameTimes) total += frameTime;
+
+        std::cerr << "Frames: " << frameTimes.size() <<
+            ", average: " << total / frameTimes.size() << " ms" <<
+            ", median: " << frameTimes[frameTimes.size() / 2] << " ms" <<
+            ", min: " << frameTimes.front() << " ms" <<
+            ", max: " << frameTimes.back() << " ms\n";
+    }
+
+    void ApplicationHeadless::write(const std::size_t frame)
+    {
+        sr::TraceScope trace{"present"};
+
+        const auto& target = getFrameBuffer();
+        const auto& data = target.getData();
+
+        switch (options.output)
+        {
+            case Output::discard:
+                break;
+            case Output::file:
+            {
+                // BMP stores the pixels as BGRA
+                auto pixels = data;
+                for (std::size_t i = 0; i + 3 < pixels.size(); i += 4)
+                    std::swap(pixels[i], pixels[i + 2]);
+
+                sr::bmp::Bmp bmp;
+                bmp.setData(target.getWidth(), target.getHeight(), pixels);
+                bmp.save(options.path + std::to_string(frame) + ".bmp");
+                break;
+            }
+            case Output::pipe:
+                if (std::fwrite(data.data(), 1, data.size(), stdout) != data.size())
+                    throw std::runtime_error{"Failed to write the frame"};
+                std::fflush(stdout);
+                break;
+        }
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    try
+    {
+        demo::ApplicationHeadless::Options options;
+        std::string tracePath;
+        bool traceCounters = false;
+
+        for (int i = 1; i < argc; ++i)
+        {
+            const std::string argument{argv[i]};
+
+            if (i + 1 >= argc)
+                throw std::runtime_error{"Missing value for " + argument};
+
+            const std::string value{argv[++i]};
+
+            if (argument == "--width")
+                options.width = std::stoul(value);
+            else if (argument == "--height")
+                options.height = std::stoul(value);
+            else if (argument == "--frames")
+                options.frameCount = std::stoul(value);
+            else if (argument == "--time")
+                options.timeBudget = std::chrono::duration<double>{std::stod(value)};
+            else if (argument == "--output")
+            {
+                if (value == "discard") options.output = demo::ApplicationHeadless::Output::discard;
+                else if (value == "file") options.output = demo::ApplicationHeadless::Output::file;
+                else if (value == "pipe") options.output = demo::ApplicationHeadless::Output::pipe;
+                else throw std::runtime_error{"Invalid output " + value};
+            }
+            else if (argument == "--path")
+                options.path = value;
+            else if (argument == "--trace")
+                tracePath = value;
+            else if (argument == "--counters")
+            {
+                if (value == "on") traceCounters = true;
+                else if (value == "off") traceCounters = false;
+                else throw std::runtime_error{"Invalid counters " + value};
+            }
+            else
+                throw std::runtime_error{"Invalid argument " + argument};
+        }
+
+        // the tracer outlives the application, so all of its threads are done when the trace is written
+        std::unique_ptr<sr::Tracer> tracer;
+        if (!tracePath.empty())
+        {
+            tracer = std::make_unique<sr::Tracer>(65536, traceCounters);
+            sr::Tracer::setThreadName("main");
+            tracer->start();
+        }
+
+        {
+            demo::ApplicationHeadless application{options};
+            application.run();
+        }
+
+        if (tracer)
+        {
+            tracer->stop();
+            std::ofstream file{tracePath};
+            tracer->write(file);
+            if (!file)
+                throw std::runtime_error{"Failed to write the trace to " + tracePath};
+        }
+
+        return EXIT_SUCCESS;
+    }
+    catch (const std::exception& e)
+    {
+        std::cerr << e.what() << std::endl;
+        return EXIT_FAILURE;
+    }
+    catch (...)
+    {
+        return EXIT_FAILURE;
+    }
+}
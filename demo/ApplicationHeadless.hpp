@@ -0,0 +1,47 @@
+//
+//  SoftwareRenderer
+//
+
+#ifndef APPLICATIONHEADLESS_HPP
+#define APPLICATIONHEADLESS_HPP
+
+#include <chrono>
+#include <string>
+#include "Application.hpp"
+
+namespace demo
+{
+    // renders offscreen without a display, for batch jobs and benchmarks
+    class ApplicationHeadless: public Application
+    {
+    public:
+        enum class Output
+        {
+            discard, // the frames are thrown away
+            file, // every frame is saved as a BMP file
+            pipe // raw RGBA frames are written to the standard output
+        };
+
+        class Options final
+        {
+        public:
+            std::size_t width = 640;
+            std::size_t height = 480;
+            std::size_t frameCount = 100; // 0 renders until the time budget runs out
+            std::chrono::duration<double> timeBudget{0.0}; // 0 means no limit
+            Output output = Output::discard;
+            std::string path = "frame"; // prefix of the file names
+        };
+
+        explicit ApplicationHeadless(const Options& initOptions);
+
+        void run();
+
+    private:
+        void write(std::size_t frame);
+
+        Options options;
+    };
+}
+
+#endif
@@ -2,13 +2,29 @@
 //  SoftwareRenderer
 //
 
+#include <fstream>
 #include <iostream>
+#include <memory>
 #include <stdexcept>
+#include <string>
+#include <sys/ipc.h>
+#include <sys/shm.h>
 #include <X11/Xutil.h>
 #include "ApplicationX11.hpp"
 
 namespace demo
 {
+    namespace
+    {
+        bool sharedMemoryError = false;
+
+        int handleSharedMemoryError(Display*, XErrorEvent*)
+        {
+            sharedMemoryError = true;
+            return 0;
+        }
+    }
+
     std::string getResourcePath()
     {
         return "Resources";
@@ -56,13 +72,44 @@ namespace demo
         gc = XCreateGC(display, window, 0, 0);
         XSetForeground(display, gc, 0);
 
+        // the extension can be present but unusable, for example if the X server runs on another machine
+        if (XShmQueryExtension(display))
+        {
+            sharedMemoryError = false;
+            const auto previousHandler = XSetErrorHandler(handleSharedMemoryError);
+
+            Frame probe;
+            sharedMemory = createSharedImage(probe, 1, 1);
+            destroySharedImage(probe);
+
+            XSync(display, False);
+            XSetErrorHandler(previousHandler);
+
+            if (sharedMemoryError) sharedMemory = false;
+        }
+
         setup(w, h);
+
+        presentThread = std::thread{&ApplicationX11::present, this};
     }
 
     ApplicationX11::~ApplicationX11()
     {
+        if (presentThread.joinable())
+        {
+            {
+                std::unique_lock lock{frameMutex};
+                presenting = false;
+            }
+            frameCondition.notify_all();
+            presentThread.join();
+        }
+
         if (display)
         {
+            for (auto& frame : frames)
+                destroySharedImage(frame);
+
             if (gc) XFreeGC(display, gc);
             if (window) XDestroyWindow(display, window);
 
@@ -72,19 +119,148 @@ namespace demo
 
     void ApplicationX11::draw()
     {
-        render();
+        std::size_t frameIndex;
+        {
+            std::unique_lock lock{frameMutex};
+            frameCondition.wait(lock, [this]() { return !freeFrames.empty(); });
+            frameIndex = freeFrames.front();
+            freeFrames.pop_front();
+        }
+
+        auto& frame = frames[frameIndex];
+        const auto frameWidth = getFrameBuffer().getWidth();
+        const auto frameHeight = getFrameBuffer().getHeight();
+        if (sharedMemory)
+        {
+            if (!frame.image ||
+                static_cast<std::size_t>(frame.image->width) != frameWidth ||
+                static_cast<std::size_t>(frame.image->height) != frameHeight)
+            {
+                destroySharedImage(frame);
+                if (frameWidth > 0 && frameHeight > 0 && !createSharedImage(frame, frameWidth, frameHeight))
+                    throw std::runtime_error{"Failed to create a shared memory image"};
+            }
 
-        const auto& frameBuffer = getFrameBuffer();
+            // the frame is resolved straight into the shared memory segment
+            if (frame.image)
+                render(sr::TextureView{sr::PixelFormat::rgba8, frame.image->data, frameWidth, frameHeight,
+                                       static_cast<std::size_t>(frame.image->bytes_per_line)});
+        }
+        else
+        {
+            if (frame.texture.getWidth() != frameWidth || frame.texture.getHeight() != frameHeight)
+                frame.texture.resize(frameWidth, frameHeight);
 
-        const auto data = frameBuffer.getData().data();
-        XImage* image = XCreateImage(display, visual, depth, ZPixmap, 0,
-                                     const_cast<char*>(reinterpret_cast<const char*>(data)),
-                                     frameBuffer.getWidth(), frameBuffer.getHeight(), 32, 0);
+            render(sr::TextureView{frame.texture});
+        }
 
-        XPutImage(display, window, gc, image, 0, 0, 0, 0,
-                  frameBuffer.getWidth(), frameBuffer.getHeight());
-        XFlush(display);
-        XFree(image);
+        {
+            std::unique_lock lock{frameMutex};
+            queuedFrames.push_back(frameIndex);
+        }
+        frameCondition.notify_all();
+    }
+
+    void ApplicationX11::present()
+    {
+        sr::Tracer::setThreadName("present");
+
+        for (;;)
+        {
+            std::size_t frameIndex;
+            {
+                std::unique_lock lock{frameMutex};
+                frameCondition.wait(lock, [this]() { return !presenting || !queuedFrames.empty(); });
+                if (!presenting) break;
+                frameIndex = queuedFrames.front();
+                queuedFrames.pop_front();
+            }
+
+            const auto& frame = frames[frameIndex];
+            const auto& frameTexture = frame.texture;
+
+            sr::TraceScope trace{"present"};
+
+            if (sharedMemory)
+            {
+                if (frame.image)
+                {
+                    XShmPutImage(display, window, gc, frame.image, 0, 0, 0, 0,
+                                 static_cast<unsigned int>(frame.image->width),
+                                 static_cast<unsigned int>(frame.image->height), False);
+
+                    // the segment can be reused once the server has copied it
+                    XSync(display, False);
+                }
+            }
+            else
+            {
+                const auto data = frameTexture.getData().data();
+                XImage* image = XCreateImage(display, visual, depth, ZPixmap, 0,
+                                             const_cast<char*>(reinterpret_cast<const char*>(data)),
+                                             frameTexture.getWidth(), frameTexture.getHeight(), 32, 0);
+
+                XPutImage(display, window, gc, image, 0, 0, 0, 0,
+                          frameTexture.getWidth(), frameTexture.getHeight());
+                XFlush(display);
+                XFree(image);
+            }
+
+            {
+                std::unique_lock lock{frameMutex};
+                freeFrames.push_back(frameIndex);
+            }
+            frameCondition.notify_all();
+        }
+    }
+
+    bool ApplicationX11::createSharedImage(Frame& frame, const std::size_t width, const std::size_t height)
+    {
+        frame.image = XShmCreateImage(display, visual, depth, ZPixmap, nullptr, &frame.shmInfo,
+                                      static_cast<unsigned int>(width), static_cast<unsigned int>(height));
+        if (!frame.image)
+            return false;
+
+        frame.shmInfo.shmid = shmget(IPC_PRIVATE,
+                                     static_cast<std::size_t>(frame.image->bytes_per_line * frame.image->height),
+                                     IPC_CREAT | 0600);
+        if (frame.shmInfo.shmid == -1)
+        {
+            XDestroyImage(frame.image);
+            frame.image = nullptr;
+            return false;
+        }
+
+        frame.shmInfo.shmaddr = frame.image->data = static_cast<char*>(shmat(frame.shmInfo.shmid, nullptr, 0));
+        frame.shmInfo.readOnly = False;
+
+        if (frame.shmInfo.shmaddr == reinterpret_cast<char*>(-1) ||
+            !XShmAttach(display, &frame.shmInfo))
+        {
+            if (frame.shmInfo.shmaddr != reinterpret_cast<char*>(-1)) shmdt(frame.shmInfo.shmaddr);
+            shmctl(frame.shmInfo.shmid, IPC_RMID, nullptr);
+            frame.image->data = nullptr;
+            XDestroyImage(frame.image);
+            frame.image = nullptr;
+            return false;
+        }
+
+        // the segment is freed as soon as both processes have detached from it
+        XSync(display, False);
+        shmctl(frame.shmInfo.shmid, IPC_RMID, nullptr);
+
+        return true;
+    }
+
+    void ApplicationX11::destroySharedImage(Frame& frame)
+    {
+        if (!frame.image) return;
+
+        XShmDetach(display, &frame.shmInfo);
+        frame.image->data = nullptr;
+        XDestroyImage(frame.image);
+        shmdt(frame.shmInfo.shmaddr);
+        frame.image = nullptr;
     }
 
     void ApplicationX11::didResize(int newWidth, int newHeight)
@@ -93,11 +269,11 @@ namespace demo
                  static_cast<std::size_t>(newHeight));
     }
 
-    void ApplicationX11::run()
+    void ApplicationX11::run(const std::size_t frameLimit)
     {
         bool running = true;
 
-        while (running)
+        for (std::size_t frame = 0; running && (frameLimit == 0 || frame < frameLimit); ++frame)
         {
             while (XPending(display))
             {
@@ -127,12 +303,45 @@ namespace demo
     }
 }
 
-int main()
+int main(int argc, char* argv[])
 {
     try
     {
-        demo::ApplicationX11 application;
-        application.run();
+        std::size_t frameLimit = 0;
+        std::string tracePath;
+        bool traceCounters = false;
+
+        for (int i = 1; i < argc; ++i)
+            if (std::string{argv[i]} == "--frames" && i + 1 < argc)
+                frameLimit = std::stoul(argv[++i]);
+            else if (std::string{argv[i]} == "--trace" && i + 1 < argc)
+                tracePath = argv[++i];
+            else if (std::string{argv[i]} == "--counters" && i + 1 < argc)
+                traceCounters = std::string{argv[++i]} == "on";
+
+        // the tracer outlives the application, so all of its threads are done when the trace is written
+        std::unique_ptr<sr::Tracer> tracer;
+        if (!tracePath.empty())
+        {
+            tracer = std::make_unique<sr::Tracer>(65536, traceCounters);
+            sr::Tracer::setThreadName("main");
+            tracer->start();
+        }
+
+        {
+            demo::ApplicationX11 application;
+            application.run(frameLimit);
+        }
+
+        if (tracer)
+        {
+            tracer->stop();
+            std::ofstream file{tracePath};
+            tracer->write(file);
+            if (!file)
+                throw std::runtime_error{"Failed to write the trace to " + tracePath};
+        }
+
         return EXIT_SUCCESS;
     }
     catch (const std::exception& e)
@@ -5,7 +5,13 @@
 #ifndef APPLICATIONX11_HPP
 #define APPLICATIONX11_HPP
 
+#include <array>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
 #include <X11/Xlib.h>
+#include <X11/extensions/XShm.h>
 #include "Application.hpp"
 
 namespace demo
@@ -19,9 +25,22 @@ namespace demo
         void draw();
         void didResize(int newWidth, int newHeight);
 
-        void run();
+        // 0 runs until the window is closed
+        void run(std::size_t frameLimit = 0);
 
     private:
+        class Frame final
+        {
+        public:
+            sr::Texture texture; // used only without MIT-SHM
+            XImage* image = nullptr; // shared with the X server, rendered into directly
+            XShmSegmentInfo shmInfo{};
+        };
+
+        bool createSharedImage(Frame& frame, std::size_t width, std::size_t height);
+        void destroySharedImage(Frame& frame);
+        void present();
+
         Visual* visual = nullptr;
         int depth;
         Display* display = nullptr;
@@ -29,6 +48,17 @@ namespace demo
         Atom protocolsAtom;
         Atom deleteAtom;
         GC gc;
+
+        // the next frame is rendered while the previous ones are being sent to the X server,
+        // the renderer waits when all the frames are queued for presentation
+        bool sharedMemory = false;
+        std::array<Frame, 3> frames;
+        std::deque<std::size_t> freeFrames{0, 1, 2};
+        std::deque<std::size_t> queuedFrames;
+        std::mutex frameMutex;
+        std::condition_variable frameCondition;
+        bool presenting = true;
+        std::thread presentThread;
     };
 }
 
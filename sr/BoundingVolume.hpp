@@ -0,0 +1,49 @@
+//
+//  SoftwareRenderer
+//
+
+#ifndef SR_BOUNDINGVOLUME_HPP
+#define SR_BOUNDINGVOLUME_HPP
+
+#include "Vector.hpp"
+
+namespace sr
+{
+    // encloses the whole mesh of a draw in model space, the draw is skipped if its volume is outside of the view
+    class BoundingVolume final
+    {
+    public:
+        enum class Type
+        {
+            none, // the draw is never culled
+            box,
+            sphere
+        };
+
+        [[nodiscard]] static BoundingVolume box(const Vector<float, 3>& min, const Vector<float, 3>& max) noexcept
+        {
+            BoundingVolume result;
+            result.type = Type::box;
+            result.min = min;
+            result.max = max;
+            return result;
+        }
+
+        [[nodiscard]] static BoundingVolume sphere(const Vector<float, 3>& center, const float radius) noexcept
+        {
+            BoundingVolume result;
+            result.type = Type::sphere;
+            result.center = center;
+            result.radius = radius;
+            return result;
+        }
+
+        Type type = Type::none;
+        Vector<float, 3> min; // corners of the axis-aligned box
+        Vector<float, 3> max;
+        Vector<float, 3> center; // of the sphere
+        float radius = 0.0F;
+    };
+}
+
+#endif
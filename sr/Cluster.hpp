@@ -0,0 +1,142 @@
+//
+//  SoftwareRenderer
+//
+
+#ifndef SR_CLUSTER_HPP
+#define SR_CLUSTER_HPP
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <limits>
+#include <vector>
+#include "CullMode.hpp"
+#include "IndexBufferView.hpp"
+#include "Matrix.hpp"
+#include "Vector.hpp"
+#include "Vertex.hpp"
+
+namespace sr
+{
+    // a run of triangles of a triangle list with the bounds of its positions and normals in model space,
+    // clusters outside of the view or facing away from the camera are skipped before their vertices are shaded
+    class Cluster final
+    {
+    public:
+        std::size_t firstIndex = 0;
+        std::size_t indexCount = 0;
+        Vector<float, 3> center;
+        float radius = 0.0F;
+        Vector<float, 3> coneAxis; // average normal of the triangles
+        float coneCosine = -1.0F; // all normals are within acos(coneCosine) of the axis, the cone is not used if it is not positive
+    };
+
+    constexpr std::size_t defaultClusterTriangleCount = 64;
+
+    // splits the triangle list into clusters of consecutive triangles without reordering the indices,
+    // so the clusters are only as tight as the index order is spatially coherent (as it is after a vertex cache optimization)
+    [[nodiscard]] inline std::vector<Cluster> buildClusters(const IndexBufferView& indices,
+                                                            const std::vector<Vertex>& vertices,
+                                                            const std::size_t triangleCount = defaultClusterTriangleCount)
+    {
+        std::vector<Cluster> clusters;
+        const auto clusterIndexCount = std::max(triangleCount, std::size_t{1}) * 3;
+        const auto indexCount = indices.getSize() - indices.getSize() % 3;
+
+        const auto getPosition = [&](const std::size_t i) {
+            const auto& position = vertices[indices[i]].position;
+            return Vector<float, 3>{position.v[0], position.v[1], position.v[2]};
+        };
+
+        for (std::size_t first = 0; first < indexCount; first += clusterIndexCount)
+        {
+            Cluster cluster;
+            cluster.firstIndex = first;
+            cluster.indexCount = std::min(clusterIndexCount, indexCount - first);
+            const auto last = first + cluster.indexCount;
+
+            // sphere around the bounding box
+            Vector<float, 3> min{std::numeric_limits<float>::max(), std::numeric_limits<float>::max(), std::numeric_limits<float>::max()};
+            Vector<float, 3> max{std::numeric_limits<float>::lowest(), std::numeric_limits<float>::lowest(), std::numeric_limits<float>::lowest()};
+            for (auto i = first; i < last; ++i)
+            {
+                const auto position = getPosition(i);
+                for (std::size_t c = 0; c < 3; ++c)
+                {
+                    min.v[c] = std::min(min.v[c], position.v[c]);
+                    max.v[c] = std::max(max.v[c], position.v[c]);
+                }
+            }
+
+            cluster.center = (min + max) / 2.0F;
+            for (auto i = first; i < last; ++i)
+                cluster.radius = std::max(cluster.radius, cluster.center.distance(getPosition(i)));
+
+            // degenerate triangles have no normal and are never rasterized
+            std::vector<Vector<float, 3>> normals;
+            for (auto i = first; i < last; i += 3)
+            {
+                const auto p0 = getPosition(i);
+                const auto normal = (getPosition(i + 1) - p0).cross(getPosition(i + 2) - p0);
+                if (normal.lengthSquared() > 0.0F) normals.push_back(normal.normalized());
+            }
+
+            Vector<float, 3> axis;
+            for (const auto& normal : normals) axis += normal;
+
+            if (!normals.empty() && axis.lengthSquared() > 0.0F)
+            {
+                cluster.coneAxis = axis.normalized();
+                cluster.coneCosine = 1.0F;
+                for (const auto& normal : normals)
+                    cluster.coneCosine = std::min(cluster.coneCosine, normal.dot(cluster.coneAxis));
+            }
+
+            clusters.push_back(cluster);
+        }
+
+        return clusters;
+    }
+
+    namespace detail
+    {
+        // the homogeneous point that the matrix projects to x = y = w = 0, the camera position for perspective projections
+        // and the direction the camera looks from (w = 0) for orthographic ones
+        [[nodiscard]] inline Vector<float, 4> getProjectionCenter(const Matrix<float, 4>& modelViewProjection) noexcept
+        {
+            // generalized cross product of the x, y and w rows of the column-major matrix
+            const auto& m = modelViewProjection.m;
+            const auto minor = [&m](const std::size_t c0, const std::size_t c1, const std::size_t c2) {
+                return m[c0 * 4 + 0] * (m[c1 * 4 + 1] * m[c2 * 4 + 3] - m[c2 * 4 + 1] * m[c1 * 4 + 3]) -
+                    m[c1 * 4 + 0] * (m[c0 * 4 + 1] * m[c2 * 4 + 3] - m[c2 * 4 + 1] * m[c0 * 4 + 3]) +
+                    m[c2 * 4 + 0] * (m[c0 * 4 + 1] * m[c1 * 4 + 3] - m[c1 * 4 + 1] * m[c0 * 4 + 3]);
+            };
+
+            return Vector<float, 4>{minor(1, 2, 3), -minor(0, 2, 3), minor(0, 1, 3), -minor(0, 1, 2)};
+        }
+
+        // a triangle with the normal n through the point p faces the camera if dot(n, center.xyz - center.w * p) > 0,
+        // the cluster is culled if this has the culled sign for every normal in the cone and every point in the sphere
+        [[nodiscard]] inline bool isConeCulled(const Cluster& cluster,
+                                               const Vector<float, 4>& projectionCenter,
+                                               const CullMode cullMode) noexcept
+        {
+            if (cullMode == CullMode::none || cluster.coneCosine <= 0.0F) return false;
+
+            const auto w = projectionCenter.v[3];
+            auto direction = Vector<float, 3>{
+                w * cluster.center.v[0] - projectionCenter.v[0],
+                w * cluster.center.v[1] - projectionCenter.v[1],
+                w * cluster.center.v[2] - projectionCenter.v[2]
+            };
+            if (cullMode == CullMode::front) direction = -direction;
+
+            // the smallest dot product of the direction and a normal in the cone, less the reach of the sphere
+            const auto coneSine = std::sqrt(1.0F - cluster.coneCosine * cluster.coneCosine);
+            return direction.dot(cluster.coneAxis) * cluster.coneCosine -
+                direction.cross(cluster.coneAxis).length() * coneSine > std::abs(w) * cluster.radius;
+        }
+    }
+}
+
+#endif
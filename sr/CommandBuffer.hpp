@@ -0,0 +1,388 @@
+//
+//  SoftwareRenderer
+//
+
+#ifndef SR_COMMANDBUFFER_HPP
+#define SR_COMMANDBUFFER_HPP
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <tuple>
+#include <vector>
+#include "BlendState.hpp"
+#include "BoundingVolume.hpp"
+#include "Cluster.hpp"
+#include "ConstantBuffer.hpp"
+#include "CullMode.hpp"
+#include "DepthState.hpp"
+#include "DrawCall.hpp"
+#include "IndexBufferView.hpp"
+#include "Instance.hpp"
+#include "JobSystem.hpp"
+#include "Matrix.hpp"
+#include "OcclusionBuffer.hpp"
+#include "PipelineStatistics.hpp"
+#include "PrimitiveTopology.hpp"
+#include "Query.hpp"
+#include "Rect.hpp"
+#include "RenderError.hpp"
+#include "Renderer.hpp"
+#include "RenderPass.hpp"
+#include "Sampler.hpp"
+#include "Shader.hpp"
+#include "Texture.hpp"
+#include "TextureView.hpp"
+#include "Vertex.hpp"
+#include "VertexLayout.hpp"
+
+namespace sr
+{
+    // records draws without executing them, every command buffer is meant to be filled by a single thread
+    class CommandBuffer final
+    {
+    public:
+        void setShaders(VertexShader* vertexShader, FragmentShader* fragmentShader) noexcept
+        {
+            state.vertexShader = vertexShader;
+            state.fragmentShader = fragmentShader;
+            dirty = true;
+        }
+
+        void setSamplers(const std::array<const Sampler*, 2>& samplers) noexcept
+        {
+            state.samplers = samplers;
+            dirty = true;
+        }
+
+        // the memory of the views must stay valid until the command buffer is executed
+        void setTextures(const std::array<TextureView, 2>& textures) noexcept
+        {
+            state.textures = textures;
+            dirty = true;
+        }
+
+        // the constants must stay alive until the command buffer is executed
+        void setConstantBuffer(const ConstantBuffer& constants) noexcept
+        {
+            state.constants = constants;
+            dirty = true;
+        }
+
+        void setViewport(const Rect<float>& viewport) noexcept
+        {
+            state.viewport = viewport;
+            dirty = true;
+        }
+
+        void setScissorRect(const Rect<float>& scissorRect) noexcept
+        {
+            state.scissorRect = scissorRect;
+            dirty = true;
+        }
+
+        void setBlendState(const BlendState& blendState) noexcept
+        {
+            state.blendState = blendState;
+            dirty = true;
+        }
+
+        void setDepthState(const DepthState& depthState) noexcept
+        {
+            state.depthState = depthState;
+            dirty = true;
+        }
+
+        void setCullMode(const CullMode cullMode) noexcept
+        {
+            state.cullMode = cullMode;
+            dirty = true;
+        }
+
+        // the occluders must be drawn into the buffer before the command buffer is executed
+        void setOcclusionBuffer(const OcclusionBuffer* occlusionBuffer) noexcept
+        {
+            state.occlusionBuffer = occlusionBuffer;
+            dirty = true;
+        }
+
+        // the samples of the draws recorded until endQuery are added to the samples passed query,
+        // which must stay alive until the command buffer is executed
+        void beginQuery(Query& query)
+        {
+            if (query.getType() != QueryType::samplesPassed)
+                throw RenderError{"Only samples passed queries can be begun"};
+
+            state.query = &query;
+            dirty = true;
+        }
+
+        void endQuery() noexcept
+        {
+            state.query = nullptr;
+            dirty = true;
+        }
+
+        // the draws recorded after this are skipped if the samples passed query is available and zero,
+        // e.g. an expensive effect is drawn only if its bounding box was visible in the previous frame
+        void setPredicate(const Query* predicate)
+        {
+            if (predicate && predicate->getType() != QueryType::samplesPassed)
+                throw RenderError{"Only samples passed queries can be predicates"};
+
+            state.predicate = predicate;
+            dirty = true;
+        }
+
+        void setPrimitiveTopology(const PrimitiveTopology topology) noexcept
+        {
+            state.topology = topology;
+            dirty = true;
+        }
+
+        void setPrimitiveRestart(const bool primitiveRestart) noexcept
+        {
+            state.primitiveRestart = primitiveRestart;
+            dirty = true;
+        }
+
+        // the layout must stay alive until the command buffer is executed, nullptr draws Vertex structures
+        void setVertexLayout(const VertexLayout* vertexLayout) noexcept
+        {
+            state.vertexLayout = vertexLayout;
+            dirty = true;
+        }
+
+        // mask of the attributes that the vertex shader reads
+        void setVertexShaderInputs(const std::uint32_t vertexShaderInputs) noexcept
+        {
+            state.vertexShaderInputs = vertexShaderInputs;
+            dirty = true;
+        }
+
+        // mask of the varyings that the fragment shader reads and the number of custom varyings it reads
+        void setFragmentShaderInputs(const std::uint32_t fragmentShaderInputs,
+                                     const std::size_t customVaryingCount = 0) noexcept
+        {
+            state.fragmentShaderInputs = fragmentShaderInputs;
+            state.customVaryingCount = customVaryingCount;
+            dirty = true;
+        }
+
+        // the index and vertex buffers and the clusters must stay alive until the command buffer is executed,
+        // the draw is skipped if the bounds (in model space) are outside of the view
+        void drawTriangles(const IndexBufferView& indices,
+                           const std::vector<Vertex>& vertices,
+                           const Matrix<float, 4>& modelViewProjection,
+                           const BoundingVolume& bounds = BoundingVolume{},
+                           const std::vector<Cluster>* clusters = nullptr)
+        {
+            addDraw(indices, &vertices, {}, 0, nullptr, modelViewProjection, bounds, clusters);
+        }
+
+        // reads the vertices from the streams with the current vertex layout
+        void drawTriangles(const IndexBufferView& indices,
+                           const std::array<VertexStream, maxVertexStreams>& vertexStreams,
+                           const std::size_t vertexCount,
+                           const Matrix<float, 4>& modelViewProjection,
+                           const BoundingVolume& bounds = BoundingVolume{},
+                           const std::vector<Cluster>* clusters = nullptr)
+        {
+            addDraw(indices, nullptr, vertexStreams, vertexCount, nullptr, modelViewProjection, bounds, clusters);
+        }
+
+        // draws the mesh once for every instance, the instances must stay alive until the command buffer is executed,
+        // every instance is culled on its own with the bounds transformed by its transform
+        void drawTrianglesInstanced(const IndexBufferView& indices,
+                                    const std::vector<Vertex>& vertices,
+                                    const std::vector<Instance>& instances,
+                                    const Matrix<float, 4>& modelViewProjection,
+                                    const BoundingVolume& bounds = BoundingVolume{},
+                                    const std::vector<Cluster>* clusters = nullptr)
+        {
+            addDraw(indices, &vertices, {}, 0, &instances, modelViewProjection, bounds, clusters);
+        }
+
+        void reset() noexcept
+        {
+            states.clear();
+            draws.clear();
+            dirty = true;
+        }
+
+        [[nodiscard]] std::size_t getDrawCount() const noexcept { return draws.size(); }
+
+        // appends the recorded draws in the order they were recorded
+        void getDrawCalls(std::vector<DrawCall>& drawCalls) const
+        {
+            drawCalls.reserve(drawCalls.size() + draws.size());
+
+            for (const auto& draw : draws)
+            {
+                const auto& drawState = states[draw.stateIndex];
+
+                DrawCall drawCall;
+                drawCall.vertexShader = drawState.vertexShader;
+                drawCall.fragmentShader = drawState.fragmentShader;
+                drawCall.samplers = drawState.samplers;
+                drawCall.textures = drawState.textures;
+                drawCall.constants = drawState.constants;
+                drawCall.viewport = drawState.viewport;
+                drawCall.scissorRect = drawState.scissorRect;
+                drawCall.blendState = drawState.blendState;
+                drawCall.depthState = drawState.depthState;
+                drawCall.cullMode = drawState.cullMode;
+                drawCall.query = drawState.query;
+                drawCall.predicate = drawState.predicate;
+                drawCall.occlusionBuffer = drawState.occlusionBuffer;
+                drawCall.topology = drawState.topology;
+                drawCall.primitiveRestart = drawState.primitiveRestart;
+                drawCall.indices = draw.indices;
+                drawCall.vertices = draw.vertices;
+                drawCall.vertexLayout = draw.vertices ? nullptr : drawState.vertexLayout;
+                drawCall.vertexStreams = draw.vertexStreams;
+                drawCall.vertexCount = draw.vertexCount;
+                drawCall.vertexShaderInputs = drawState.vertexShaderInputs;
+                drawCall.fragmentShaderInputs = drawState.fragmentShaderInputs;
+                drawCall.customVaryingCount = drawState.customVaryingCount;
+                drawCall.instances = draw.instances;
+                drawCall.modelViewProjection = draw.modelViewProjection;
+                drawCall.bounds = draw.bounds;
+                drawCall.clusters = draw.clusters;
+                drawCalls.push_back(drawCall);
+            }
+        }
+
+    private:
+        class State final
+        {
+        public:
+            VertexShader* vertexShader = nullptr;
+            FragmentShader* fragmentShader = nullptr;
+            std::array<const Sampler*, 2> samplers{};
+            std::array<TextureView, 2> textures{};
+            ConstantBuffer constants;
+            Rect<float> viewport;
+            Rect<float> scissorRect{0.0F, 0.0F, 1.0F, 1.0F};
+            BlendState blendState;
+            DepthState depthState;
+            CullMode cullMode = CullMode::none;
+            Query* query = nullptr;
+            const Query* predicate = nullptr;
+            const OcclusionBuffer* occlusionBuffer = nullptr;
+            PrimitiveTopology topology = PrimitiveTopology::triangleList;
+            bool primitiveRestart = false;
+            const VertexLayout* vertexLayout = nullptr;
+            std::uint32_t vertexShaderInputs = allVertexAttributes;
+            std::uint32_t fragmentShaderInputs = allVaryings;
+            std::size_t customVaryingCount = 0;
+        };
+
+        class Draw final
+        {
+        public:
+            std::uint32_t stateIndex;
+            IndexBufferView indices;
+            const std::vector<Vertex>* vertices;
+            std::array<VertexStream, maxVertexStreams> vertexStreams;
+            std::size_t vertexCount;
+            const std::vector<Instance>* instances;
+            Matrix<float, 4> modelViewProjection;
+            BoundingVolume bounds;
+            const std::vector<Cluster>* clusters;
+        };
+
+        void addDraw(const IndexBufferView& indices,
+                     const std::vector<Vertex>* vertices,
+                     const std::array<VertexStream, maxVertexStreams>& vertexStreams,
+                     const std::size_t vertexCount,
+                     const std::vector<Instance>* instances,
+                     const Matrix<float, 4>& modelViewProjection,
+                     const BoundingVolume& bounds,
+                     const std::vector<Cluster>* clusters)
+        {
+            if (dirty || states.empty())
+            {
+                states.push_back(state);
+                dirty = false;
+            }
+
+            draws.push_back(Draw{static_cast<std::uint32_t>(states.size() - 1), indices, vertices, vertexStreams, vertexCount, instances, modelViewProjection, bounds, clusters});
+        }
+
+        State state;
+        bool dirty = true;
+        std::vector<State> states;
+        std::vector<Draw> draws;
+    };
+
+    // draws that write and test depth without blending produce the same image in any order,
+    // except where they cover a sample at exactly the same depth (the depth test passes on equal depths, so the last one wins),
+    // draws with queries or predicates keep their place, because the samples that pass depend on the order
+    [[nodiscard]] inline bool isReorderable(const DrawCall& drawCall) noexcept
+    {
+        return !drawCall.blendState.enabled &&
+            drawCall.depthState.read &&
+            drawCall.depthState.write &&
+            !drawCall.query &&
+            !drawCall.predicate;
+    }
+
+    // clip space z of the model origin, grows with the distance from the camera for both perspective and orthographic projections
+    [[nodiscard]] inline float getSortDepth(const DrawCall& drawCall) noexcept
+    {
+        return drawCall.modelViewProjection.m[14];
+    }
+
+    // groups the runs of reorderable draws by pipeline state and sorts them front to back within a state,
+    // other draws act as barriers and keep their place
+    inline void sortDrawCalls(std::vector<DrawCall>& drawCalls)
+    {
+        const auto getKey = [](const DrawCall& drawCall) {
+            return std::make_tuple(reinterpret_cast<std::uintptr_t>(drawCall.vertexShader),
+                                   reinterpret_cast<std::uintptr_t>(drawCall.fragmentShader),
+                                   reinterpret_cast<std::uintptr_t>(drawCall.textures[0].getData()),
+                                   reinterpret_cast<std::uintptr_t>(drawCall.textures[1].getData()),
+                                   getSortDepth(drawCall));
+        };
+
+        const auto compare = [&getKey](const DrawCall& a, const DrawCall& b) {
+            return getKey(a) < getKey(b);
+        };
+
+        auto begin = drawCalls.begin();
+        while (begin != drawCalls.end())
+        {
+            begin = std::find_if(begin, drawCalls.end(), isReorderable);
+            const auto end = std::find_if_not(begin, drawCalls.end(), isReorderable);
+            std::stable_sort(begin, end, compare);
+            begin = end;
+        }
+    }
+
+    // statistics receives the sum of the counters of all the draws
+    inline void execute(const RenderPass& renderPass,
+                        const std::vector<const CommandBuffer*>& commandBuffers,
+                        const bool sort = true,
+                        JobSystem* jobSystem = nullptr,
+                        PipelineStatistics* statistics = nullptr)
+    {
+        std::vector<DrawCall> drawCalls;
+        for (const auto commandBuffer : commandBuffers)
+            commandBuffer->getDrawCalls(drawCalls);
+
+        if (sort) sortDrawCalls(drawCalls);
+
+        std::vector<PipelineStatistics> drawStatistics;
+        drawTriangles(renderPass, drawCalls, jobSystem, statistics ? &drawStatistics : nullptr);
+
+        if (statistics)
+        {
+            *statistics = PipelineStatistics{};
+            for (const auto& counters : drawStatistics)
+                *statistics += counters;
+        }
+    }
+}
+
+#endif
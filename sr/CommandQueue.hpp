@@ -0,0 +1,135 @@
+//
+//  SoftwareRenderer
+//
+
+#ifndef SR_COMMANDQUEUE_HPP
+#define SR_COMMANDQUEUE_HPP
+
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+#include "CommandBuffer.hpp"
+#include "JobSystem.hpp"
+#include "RenderPass.hpp"
+
+namespace sr
+{
+    // executes the submitted command buffers in order on its own thread, so that the
+    // caller can record the next frame while the previous one is being rasterized
+    class CommandQueue final
+    {
+    public:
+        // the submissions are rasterized with the job system if one is given, it must outlive the queue
+        explicit CommandQueue(JobSystem* initJobSystem = nullptr):
+            jobSystem{initJobSystem},
+            thread{&CommandQueue::run, this}
+        {
+        }
+
+        ~CommandQueue()
+        {
+            {
+                std::unique_lock lock{mutex};
+                running = false;
+            }
+            condition.notify_all();
+            thread.join();
+        }
+
+        CommandQueue(const CommandQueue&) = delete;
+        CommandQueue& operator=(const CommandQueue&) = delete;
+        CommandQueue(CommandQueue&&) = delete;
+        CommandQueue& operator=(CommandQueue&&) = delete;
+
+        // the command buffers are moved into the queue, the attachments of the
+        // render pass must not be accessed until the submission has completed
+        void submit(const RenderPass& renderPass,
+                    std::vector<CommandBuffer> commandBuffers,
+                    const bool sort = true)
+        {
+            {
+                std::unique_lock lock{mutex};
+                submissions.push_back(Submission{renderPass, std::move(commandBuffers), sort});
+            }
+            condition.notify_all();
+        }
+
+        // blocks until every submission has been executed and rethrows the first error
+        void waitIdle()
+        {
+            std::unique_lock lock{mutex};
+            condition.wait(lock, [this]() { return submissions.empty() && !busy; });
+
+            if (error)
+                std::rethrow_exception(std::exchange(error, nullptr));
+        }
+
+        [[nodiscard]] bool isIdle() const
+        {
+            std::unique_lock lock{mutex};
+            return submissions.empty() && !busy;
+        }
+
+    private:
+        class Submission final
+        {
+        public:
+            RenderPass renderPass;
+            std::vector<CommandBuffer> commandBuffers;
+            bool sort = true;
+        };
+
+        void run()
+        {
+            std::unique_lock lock{mutex};
+
+            for (;;)
+            {
+                condition.wait(lock, [this]() { return !running || !submissions.empty(); });
+
+                if (submissions.empty())
+                    break;
+
+                auto submission = std::move(submissions.front());
+                submissions.pop_front();
+                busy = true;
+                lock.unlock();
+
+                std::exception_ptr submissionError;
+
+                try
+                {
+                    std::vector<const CommandBuffer*> commandBuffers;
+                    for (const auto& commandBuffer : submission.commandBuffers)
+                        commandBuffers.push_back(&commandBuffer);
+
+                    execute(submission.renderPass, commandBuffers, submission.sort, jobSystem);
+                }
+                catch (...)
+                {
+                    submissionError = std::current_exception();
+                }
+
+                lock.lock();
+                if (!error) error = submissionError;
+                busy = false;
+                condition.notify_all();
+            }
+        }
+
+        JobSystem* jobSystem = nullptr;
+        mutable std::mutex mutex;
+        std::condition_variable condition;
+        std::deque<Submission> submissions;
+        bool running = true;
+        bool busy = false;
+        std::exception_ptr error;
+        std::thread thread;
+    };
+}
+
+#endif
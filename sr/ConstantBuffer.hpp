@@ -0,0 +1,47 @@
+//
+//  SoftwareRenderer
+//
+
+#ifndef SR_CONSTANTBUFFER_HPP
+#define SR_CONSTANTBUFFER_HPP
+
+#include <cstddef>
+#include <type_traits>
+
+namespace sr
+{
+    // the shader constants of a draw (matrices, light parameters, time) in memory owned by someone else,
+    // the memory must outlive the draw and is only read while the draw is rendered
+    class ConstantBuffer final
+    {
+    public:
+        ConstantBuffer() = default;
+
+        template <class T, typename std::enable_if<!std::is_same<T, ConstantBuffer>::value>::type* = nullptr>
+        explicit ConstantBuffer(const T& constants) noexcept:
+            data{&constants},
+            size{sizeof(T)}
+        {
+        }
+
+        // the buffer would outlive a temporary
+        template <class T, typename std::enable_if<!std::is_same<T, ConstantBuffer>::value>::type* = nullptr>
+        explicit ConstantBuffer(const T&& constants) = delete;
+
+        // the constants as the type the shader expects, nullptr if the buffer is too small for it
+        template <class T>
+        [[nodiscard]] const T* get() const noexcept
+        {
+            return (data && sizeof(T) <= size) ? static_cast<const T*>(data) : nullptr;
+        }
+
+        [[nodiscard]] const void* getData() const noexcept { return data; }
+        [[nodiscard]] std::size_t getSize() const noexcept { return size; }
+
+    private:
+        const void* data = nullptr;
+        std::size_t size = 0;
+    };
+}
+
+#endif
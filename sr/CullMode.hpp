@@ -0,0 +1,19 @@
+//
+//  SoftwareRenderer
+//
+
+#ifndef SR_CULLMODE_HPP
+#define SR_CULLMODE_HPP
+
+namespace sr
+{
+    // front faces are counter-clockwise in normalized device coordinates
+    enum class CullMode
+    {
+        none,
+        front,
+        back
+    };
+}
+
+#endif
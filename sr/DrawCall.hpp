@@ -0,0 +1,66 @@
+//
+//  SoftwareRenderer
+//
+
+#ifndef SR_DRAWCALL_HPP
+#define SR_DRAWCALL_HPP
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "BlendState.hpp"
+#include "BoundingVolume.hpp"
+#include "Cluster.hpp"
+#include "ConstantBuffer.hpp"
+#include "CullMode.hpp"
+#include "DepthState.hpp"
+#include "IndexBufferView.hpp"
+#include "Instance.hpp"
+#include "Matrix.hpp"
+#include "OcclusionBuffer.hpp"
+#include "PrimitiveTopology.hpp"
+#include "Query.hpp"
+#include "Rect.hpp"
+#include "Sampler.hpp"
+#include "Shader.hpp"
+#include "TextureView.hpp"
+#include "Vertex.hpp"
+#include "VertexLayout.hpp"
+
+namespace sr
+{
+    class DrawCall final
+    {
+    public:
+        VertexShader* vertexShader = nullptr;
+        FragmentShader* fragmentShader = nullptr;
+        std::array<const Sampler*, 2> samplers{};
+        std::array<TextureView, 2> textures{}; // textures or external memory, valid until the draw is rendered
+        ConstantBuffer constants;
+        Rect<float> viewport;
+        Rect<float> scissorRect{0.0F, 0.0F, 1.0F, 1.0F};
+        BlendState blendState;
+        DepthState depthState;
+        CullMode cullMode = CullMode::none;
+        PrimitiveTopology topology = PrimitiveTopology::triangleList;
+        bool primitiveRestart = false; // the largest value of the index type starts a new strip or fan
+        IndexBufferView indices;
+        const std::vector<Vertex>* vertices = nullptr; // read if there is no vertex layout
+        const VertexLayout* vertexLayout = nullptr; // describes the vertex streams
+        std::array<VertexStream, maxVertexStreams> vertexStreams{};
+        std::size_t vertexCount = 0; // vertices in the streams
+        std::uint32_t vertexShaderInputs = allVertexAttributes; // only these attributes are fetched from the streams
+        std::uint32_t fragmentShaderInputs = allVaryings; // only these varyings are interpolated, the others are zero
+        std::size_t customVaryingCount = 0; // the first custom varyings are interpolated
+        const std::vector<Instance>* instances = nullptr; // the mesh is drawn once for every instance, or once without instances
+        Matrix<float, 4> modelViewProjection = Matrix<float, 4>::identity();
+        BoundingVolume bounds; // the draw, or every instance of it, is skipped if the volume is outside of the view
+        Query* query = nullptr; // samples passed query that the samples of the draw are added to
+        const Query* predicate = nullptr; // the draw is skipped if this samples passed query is available and no samples passed
+        const OcclusionBuffer* occlusionBuffer = nullptr; // the bounds and the clusters hidden behind its occluders are skipped
+        const std::vector<Cluster>* clusters = nullptr; // the visible clusters of a triangle list are drawn, or all triangles without clusters
+    };
+}
+
+#endif
@@ -0,0 +1,103 @@
+//
+//  SoftwareRenderer
+//
+
+#ifndef SR_FRUSTUM_HPP
+#define SR_FRUSTUM_HPP
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include "BoundingVolume.hpp"
+#include "Matrix.hpp"
+#include "Vector.hpp"
+
+namespace sr
+{
+    enum class Containment
+    {
+        outside,
+        intersecting,
+        inside
+    };
+
+    // planes of the clip volume (-w <= x <= w, -w <= y <= w, 0 <= z <= w) in the space before the matrix,
+    // a point is on the inner side of a plane if dot(plane, (x, y, z, 1)) >= 0
+    class Frustum final
+    {
+    public:
+        explicit Frustum(const Matrix<float, 4>& modelViewProjection) noexcept
+        {
+            // rows of the column-major matrix
+            std::array<Vector<float, 4>, 4> rows;
+            for (std::size_t i = 0; i < 4; ++i)
+                rows[i] = Vector<float, 4>{
+                    modelViewProjection.m[i],
+                    modelViewProjection.m[4 + i],
+                    modelViewProjection.m[8 + i],
+                    modelViewProjection.m[12 + i]
+                };
+
+            planes[0] = rows[3] + rows[0]; // left
+            planes[1] = rows[3] - rows[0]; // right
+            planes[2] = rows[3] + rows[1]; // bottom
+            planes[3] = rows[3] - rows[1]; // top
+            planes[4] = rows[2]; // near
+            planes[5] = rows[3] - rows[2]; // far
+
+            // normalized, so that the distances can be compared with the radius of a sphere
+            for (auto& plane : planes)
+            {
+                const auto length = std::sqrt(plane.v[0] * plane.v[0] + plane.v[1] * plane.v[1] + plane.v[2] * plane.v[2]);
+                if (length > 0.0F) plane /= length;
+            }
+        }
+
+        // conservative, a volume near a corner of the frustum can be reported as intersecting while it is outside
+        [[nodiscard]] Containment getContainment(const BoundingVolume& volume) const noexcept
+        {
+            auto result = Containment::inside;
+
+            for (const auto& plane : planes)
+            {
+                float nearest;
+                float farthest;
+
+                if (volume.type == BoundingVolume::Type::box)
+                {
+                    // the corners of the box farthest along and against the plane normal
+                    nearest = plane.v[3];
+                    farthest = plane.v[3];
+                    for (std::size_t i = 0; i < 3; ++i)
+                    {
+                        const auto a = plane.v[i] * volume.min.v[i];
+                        const auto b = plane.v[i] * volume.max.v[i];
+                        nearest += std::min(a, b);
+                        farthest += std::max(a, b);
+                    }
+                }
+                else if (volume.type == BoundingVolume::Type::sphere)
+                {
+                    const auto distance = plane.v[0] * volume.center.v[0] +
+                        plane.v[1] * volume.center.v[1] +
+                        plane.v[2] * volume.center.v[2] +
+                        plane.v[3];
+                    nearest = distance - volume.radius;
+                    farthest = distance + volume.radius;
+                }
+                else
+                    return Containment::intersecting;
+
+                if (farthest < 0.0F) return Containment::outside;
+                if (nearest < 0.0F) result = Containment::intersecting;
+            }
+
+            return result;
+        }
+
+        std::array<Vector<float, 4>, 6> planes;
+    };
+}
+
+#endif
@@ -0,0 +1,83 @@
+//
+//  SoftwareRenderer
+//
+
+#ifndef SR_INDEXBUFFERVIEW_HPP
+#define SR_INDEXBUFFERVIEW_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace sr
+{
+    enum class IndexType
+    {
+        uint16,
+        uint32
+    };
+
+    // 16 or 32-bit indices of a vector or of memory owned by someone else (a loaded mesh, a mapped file),
+    // the memory must outlive the view
+    class IndexBufferView final
+    {
+    public:
+        IndexBufferView() = default;
+
+        IndexBufferView(const std::uint16_t* initData, const std::size_t initSize) noexcept:
+            type{IndexType::uint16},
+            data{initData},
+            size{initSize}
+        {
+        }
+
+        IndexBufferView(const std::uint32_t* initData, const std::size_t initSize) noexcept:
+            type{IndexType::uint32},
+            data{initData},
+            size{initSize}
+        {
+        }
+
+        IndexBufferView(const std::vector<std::uint16_t>& indices) noexcept:
+            IndexBufferView{indices.data(), indices.size()}
+        {
+        }
+
+        IndexBufferView(const std::vector<std::uint32_t>& indices) noexcept:
+            IndexBufferView{indices.data(), indices.size()}
+        {
+        }
+
+        // the view would outlive a temporary vector
+        IndexBufferView(std::vector<std::uint16_t>&&) = delete;
+        IndexBufferView(std::vector<std::uint32_t>&&) = delete;
+
+        [[nodiscard]] IndexType getType() const noexcept { return type; }
+        [[nodiscard]] std::size_t getSize() const noexcept { return size; }
+        [[nodiscard]] bool isEmpty() const noexcept { return size == 0; }
+
+        [[nodiscard]] std::size_t operator[](const std::size_t i) const noexcept
+        {
+            return (type == IndexType::uint16) ?
+                static_cast<const std::uint16_t*>(data)[i] :
+                static_cast<const std::uint32_t*>(data)[i];
+        }
+
+        // calls the function with a pointer to the indices in their own type,
+        // so that loops over the indices do not check the type of every index
+        template <class Function>
+        decltype(auto) visit(Function&& function) const
+        {
+            return (type == IndexType::uint16) ?
+                function(static_cast<const std::uint16_t*>(data)) :
+                function(static_cast<const std::uint32_t*>(data));
+        }
+
+    private:
+        IndexType type = IndexType::uint16;
+        const void* data = nullptr;
+        std::size_t size = 0;
+    };
+}
+
+#endif
@@ -0,0 +1,22 @@
+//
+//  SoftwareRenderer
+//
+
+#ifndef SR_INSTANCE_HPP
+#define SR_INSTANCE_HPP
+
+#include "Color.hpp"
+#include "Matrix.hpp"
+
+namespace sr
+{
+    // per-instance data of an instanced draw, passed to the vertex shader together with every vertex
+    class Instance final
+    {
+    public:
+        Matrix<float, 4> transform = Matrix<float, 4>::identity(); // applied before the model view projection matrix of the draw
+        Color color{1.0F, 1.0F, 1.0F, 1.0F};
+    };
+}
+
+#endif
@@ -0,0 +1,271 @@
+//
+//  SoftwareRenderer
+//
+
+#ifndef SR_JOBSYSTEM_HPP
+#define SR_JOBSYSTEM_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+#if defined(__linux__)
+#  include <pthread.h>
+#  include <sched.h>
+#endif
+#include "Trace.hpp"
+
+namespace sr
+{
+    // pool of worker threads with a deque per worker, idle workers steal from the others
+    class JobSystem final
+    {
+    public:
+        // counts the unfinished jobs of a fork/join section
+        class JobGroup final
+        {
+        public:
+            JobGroup() = default;
+            JobGroup(const JobGroup&) = delete;
+            JobGroup& operator=(const JobGroup&) = delete;
+
+            [[nodiscard]] bool isDone() const noexcept { return pending.load(std::memory_order_acquire) == 0; }
+
+        private:
+            friend JobSystem;
+
+            std::atomic<std::size_t> pending{0};
+            std::mutex errorMutex;
+            std::exception_ptr error;
+        };
+
+        // threadCount workers are started, the threads that wait for a group also execute jobs,
+        // worker i is pinned to the CPU affinity[i % affinity.size()] if the platform allows it
+        explicit JobSystem(const std::size_t threadCount = std::max(std::thread::hardware_concurrency(), 1U) - 1,
+                           const std::vector<std::size_t>& affinity = {}):
+            queues(threadCount + 1)
+        {
+            for (auto& queue : queues)
+                queue = std::make_unique<Queue>();
+
+            threads.reserve(threadCount);
+            for (std::size_t i = 0; i < threadCount; ++i)
+            {
+                threads.emplace_back(&JobSystem::work, this, i + 1);
+
+#if defined(__linux__)
+                if (!affinity.empty())
+                {
+                    cpu_set_t cpuSet;
+                    CPU_ZERO(&cpuSet);
+                    CPU_SET(affinity[i % affinity.size()], &cpuSet);
+                    pthread_setaffinity_np(threads.back().native_handle(), sizeof(cpuSet), &cpuSet);
+                }
+#endif
+            }
+        }
+
+        ~JobSystem()
+        {
+            {
+                std::unique_lock lock{sleepMutex};
+                running = false;
+            }
+            sleepCondition.notify_all();
+
+            for (auto& thread : threads)
+                thread.join();
+        }
+
+        JobSystem(const JobSystem&) = delete;
+        JobSystem& operator=(const JobSystem&) = delete;
+        JobSystem(JobSystem&&) = delete;
+        JobSystem& operator=(JobSystem&&) = delete;
+
+        [[nodiscard]] std::size_t getThreadCount() const noexcept { return threads.size(); }
+
+        // number of distinct values getWorkerIndex can return
+        [[nodiscard]] std::size_t getWorkerCount() const noexcept { return queues.size(); }
+
+        // 1...threadCount on the workers, 0 on any other thread
+        [[nodiscard]] std::size_t getWorkerIndex() const noexcept
+        {
+            return (currentJobSystem() == this) ? currentWorkerIndex() : 0;
+        }
+
+        void run(JobGroup& group, std::function<void()> job)
+        {
+            group.pending.fetch_add(1, std::memory_order_relaxed);
+            queuedJobs.fetch_add(1, std::memory_order_release);
+
+            auto& queue = *queues[getWorkerIndex()];
+            {
+                std::unique_lock lock{queue.mutex};
+                queue.jobs.push_back(Job{std::move(job), &group});
+            }
+
+            // taking the lock makes sure that a worker is either awake or already waiting for the notification
+            {
+                std::unique_lock lock{sleepMutex};
+            }
+            sleepCondition.notify_one();
+        }
+
+        // executes jobs until all the jobs of the group are done, rethrows the first error of the group
+        void wait(JobGroup& group)
+        {
+            const auto workerIndex = getWorkerIndex();
+
+            while (!group.isDone())
+                if (!execute(workerIndex))
+                    std::this_thread::yield();
+
+            if (group.error)
+                std::rethrow_exception(std::exchange(group.error, nullptr));
+        }
+
+        // calls function(rangeBegin, rangeEnd) for chunks of at most grainSize items and waits for all of them
+        template <class Function>
+        void parallelFor(const std::size_t begin,
+                         const std::size_t end,
+                         const std::size_t grainSize,
+                         const Function& function)
+        {
+            if (begin >= end) return;
+
+            const auto grain = std::max(grainSize, static_cast<std::size_t>(1));
+
+            if (threads.empty() || end - begin <= grain)
+            {
+                for (auto i = begin; i < end; i += grain)
+                    function(i, std::min(i + grain, end));
+                return;
+            }
+
+            JobGroup group;
+            for (auto i = begin; i < end; i += grain)
+            {
+                const auto rangeEnd = std::min(i + grain, end);
+                run(group, [&function, i, rangeEnd]() { function(i, rangeEnd); });
+            }
+            wait(group);
+        }
+
+    private:
+        class Job final
+        {
+        public:
+            std::function<void()> function;
+            JobGroup* group = nullptr;
+        };
+
+        class Queue final
+        {
+        public:
+            std::mutex mutex;
+            std::deque<Job> jobs;
+        };
+
+        static const JobSystem*& currentJobSystem() noexcept
+        {
+            thread_local const JobSystem* jobSystem = nullptr;
+            return jobSystem;
+        }
+
+        static std::size_t& currentWorkerIndex() noexcept
+        {
+            thread_local std::size_t workerIndex = 0;
+            return workerIndex;
+        }
+
+        // the owner takes the newest job from its own deque, thieves take the oldest ones
+        bool pop(const std::size_t workerIndex, Job& job)
+        {
+            {
+                auto& queue = *queues[workerIndex];
+                std::unique_lock lock{queue.mutex};
+                if (!queue.jobs.empty())
+                {
+                    job = std::move(queue.jobs.back());
+                    queue.jobs.pop_back();
+                    return true;
+                }
+            }
+
+            for (std::size_t i = 1; i < queues.size(); ++i)
+            {
+                auto& queue = *queues[(workerIndex + i) % queues.size()];
+                std::unique_lock lock{queue.mutex};
+                if (!queue.jobs.empty())
+                {
+                    job = std::move(queue.jobs.front());
+                    queue.jobs.pop_front();
+                    return true;
+                }
+            }
+
+            return false;
+        }
+
+        bool execute(const std::size_t workerIndex)
+        {
+            Job job;
+            if (!pop(workerIndex, job))
+                return false;
+
+            queuedJobs.fetch_sub(1, std::memory_order_relaxed);
+
+            try
+            {
+                TraceScope trace{"job"};
+                job.function();
+            }
+            catch (...)
+            {
+                std::unique_lock lock{job.group->errorMutex};
+                if (!job.group->error) job.group->error = std::current_exception();
+            }
+
+            job.group->pending.fetch_sub(1, std::memory_order_acq_rel);
+            return true;
+        }
+
+        void work(const std::size_t workerIndex)
+        {
+            currentJobSystem() = this;
+            currentWorkerIndex() = workerIndex;
+            Tracer::setThreadName("worker " + std::to_string(workerIndex));
+
+            for (;;)
+            {
+                if (execute(workerIndex))
+                    continue;
+
+                std::unique_lock lock{sleepMutex};
+                sleepCondition.wait(lock, [this]() {
+                    return !running || queuedJobs.load(std::memory_order_acquire) > 0;
+                });
+
+                if (!running) break;
+            }
+        }
+
+        std::vector<std::unique_ptr<Queue>> queues; // 0 is shared by all the threads that are not workers
+        std::atomic<std::size_t> queuedJobs{0};
+        std::mutex sleepMutex;
+        std::condition_variable sleepCondition;
+        bool running = true;
+        std::vector<std::thread> threads;
+    };
+}
+
+#endif
@@ -9,6 +9,8 @@
 #include <array>
 #include <cassert>
 #include <cmath>
+#include <limits>
+#include "Constants.hpp"
 #include "Vector.hpp"
 
 namespace sr
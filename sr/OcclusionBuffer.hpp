@@ -0,0 +1,204 @@
+//
+//  SoftwareRenderer
+//
+
+#ifndef SR_OCCLUSIONBUFFER_HPP
+#define SR_OCCLUSIONBUFFER_HPP
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <limits>
+#include <vector>
+#include "BoundingVolume.hpp"
+#include "IndexBufferView.hpp"
+#include "Matrix.hpp"
+#include "Vector.hpp"
+#include "Vertex.hpp"
+
+namespace sr
+{
+    // a small depth buffer of the whole view that the occluders are drawn into and the bounding volumes of
+    // the other objects are tested against, both with the same view and projection as the draws
+    class OcclusionBuffer final
+    {
+    public:
+        static constexpr std::size_t defaultWidth = 256;
+        static constexpr std::size_t defaultHeight = 128;
+
+        explicit OcclusionBuffer(const std::size_t initWidth = defaultWidth,
+                                 const std::size_t initHeight = defaultHeight):
+            width{initWidth},
+            height{initHeight},
+            depths(initWidth * initHeight, 1.0F)
+        {
+        }
+
+        [[nodiscard]] std::size_t getWidth() const noexcept { return width; }
+        [[nodiscard]] std::size_t getHeight() const noexcept { return height; }
+
+        // rows of depths in normalized device coordinates, starting at the bottom of the view
+        [[nodiscard]] const std::vector<float>& getDepths() const noexcept { return depths; }
+
+        void clear() noexcept
+        {
+            std::fill(depths.begin(), depths.end(), 1.0F);
+        }
+
+        // draws a triangle list into the pixels whose centers the triangles cover (as the pixels of drawTriangles are),
+        // with the farthest depth of the triangle plane within the pixel, triangles crossing the camera plane are left out,
+        // requiring the whole pixel to be covered would leave holes along the inner edges of the mesh
+        void drawOccluder(const IndexBufferView& indices,
+                          const std::vector<Vertex>& vertices,
+                          const Matrix<float, 4>& modelViewProjection)
+        {
+            positions.resize(vertices.size());
+            for (std::size_t v = 0; v < vertices.size(); ++v)
+                positions[v] = toScreen(modelViewProjection * vertices[v].position);
+
+            indices.visit([&](const auto data) {
+                for (std::size_t i = 0; i + 2 < indices.getSize(); i += 3)
+                    drawTriangle(positions[data[i]], positions[data[i + 1]], positions[data[i + 2]]);
+            });
+        }
+
+        // false if the volume is hidden behind the occluders in every pixel its screen rectangle touches or is outside of the view,
+        // the rectangle is grown by a pixel on each side, because an occluder covers the whole pixel if it covers its center
+        [[nodiscard]] bool isVisible(const BoundingVolume& volume,
+                                     const Matrix<float, 4>& modelViewProjection) const noexcept
+        {
+            if (volume.type == BoundingVolume::Type::none) return true;
+
+            const auto sphere = volume.type == BoundingVolume::Type::sphere;
+            const Vector<float, 3> extent{volume.radius, volume.radius, volume.radius};
+            const auto min = sphere ? volume.center - extent : volume.min;
+            const auto max = sphere ? volume.center + extent : volume.max;
+
+            // the screen rectangle and the nearest depth of the corners of the box
+            Vector<float, 3> screenMin{std::numeric_limits<float>::max(), std::numeric_limits<float>::max(), std::numeric_limits<float>::max()};
+            Vector<float, 2> screenMax{std::numeric_limits<float>::lowest(), std::numeric_limits<float>::lowest()};
+
+            for (std::size_t corner = 0; corner < 8; ++corner)
+            {
+                const auto position = toScreen(modelViewProjection * Vector<float, 4>{
+                    (corner & 1) ? max.v[0] : min.v[0],
+                    (corner & 2) ? max.v[1] : min.v[1],
+                    (corner & 4) ? max.v[2] : min.v[2],
+                    1.0F
+                });
+
+                if (!position.inFront) return true;
+
+                screenMin.v[0] = std::min(screenMin.v[0], position.x);
+                screenMin.v[1] = std::min(screenMin.v[1], position.y);
+                screenMin.v[2] = std::min(screenMin.v[2], position.z);
+                screenMax.v[0] = std::max(screenMax.v[0], position.x);
+                screenMax.v[1] = std::max(screenMax.v[1], position.y);
+            }
+
+            if (screenMax.v[0] <= 0.0F || screenMax.v[1] <= 0.0F ||
+                screenMin.v[0] >= static_cast<float>(width) || screenMin.v[1] >= static_cast<float>(height))
+                return false;
+
+            const auto minX = static_cast<std::size_t>(std::max(screenMin.v[0] - 1.0F, 0.0F));
+            const auto minY = static_cast<std::size_t>(std::max(screenMin.v[1] - 1.0F, 0.0F));
+            const auto maxX = std::max(static_cast<std::size_t>(std::min(std::ceil(screenMax.v[0] + 1.0F), static_cast<float>(width))), minX + 1) - 1;
+            const auto maxY = std::max(static_cast<std::size_t>(std::min(std::ceil(screenMax.v[1] + 1.0F), static_cast<float>(height))), minY + 1) - 1;
+
+            for (auto y = minY; y <= maxY; ++y)
+            {
+                const auto row = &depths[y * width];
+                for (auto x = minX; x <= maxX; ++x)
+                    if (screenMin.v[2] <= row[x]) return true;
+            }
+
+            return false;
+        }
+
+    private:
+        class ScreenPosition final
+        {
+        public:
+            float x = 0.0F;
+            float y = 0.0F;
+            float z = 0.0F;
+            bool inFront = false; // in front of the plane of the camera
+        };
+
+        [[nodiscard]] ScreenPosition toScreen(const Vector<float, 4>& clipPosition) const noexcept
+        {
+            ScreenPosition result;
+            result.inFront = clipPosition.v[3] > std::numeric_limits<float>::epsilon();
+            if (!result.inFront) return result;
+
+            result.x = (clipPosition.v[0] / clipPosition.v[3] * 0.5F + 0.5F) * static_cast<float>(width);
+            result.y = (clipPosition.v[1] / clipPosition.v[3] * 0.5F + 0.5F) * static_cast<float>(height);
+            result.z = clipPosition.v[2] / clipPosition.v[3];
+            return result;
+        }
+
+        void drawTriangle(ScreenPosition p0, ScreenPosition p1, ScreenPosition p2) noexcept
+        {
+            if (!p0.inFront || !p1.inFront || !p2.inFront) return;
+
+            auto area = (p1.x - p0.x) * (p2.y - p0.y) - (p2.x - p0.x) * (p1.y - p0.y);
+            if (!(std::fabs(area) > 0.0F)) return; // degenerate or not finite
+
+            // both windings occlude, the edge functions are positive inside of a counter-clockwise triangle
+            if (area < 0.0F)
+            {
+                std::swap(p1, p2);
+                area = -area;
+            }
+
+            const auto minX = std::max(std::floor(std::min({p0.x, p1.x, p2.x})), 0.0F);
+            const auto minY = std::max(std::floor(std::min({p0.y, p1.y, p2.y})), 0.0F);
+            const auto maxX = std::min(std::ceil(std::max({p0.x, p1.x, p2.x})), static_cast<float>(width));
+            const auto maxY = std::min(std::ceil(std::max({p0.y, p1.y, p2.y})), static_cast<float>(height));
+            if (minX >= maxX || minY >= maxY) return;
+
+            // a * x + b * y + c of every edge, moved to the center of the pixel
+            const std::array<const ScreenPosition*, 4> points{&p0, &p1, &p2, &p0};
+            std::array<float, 3> a;
+            std::array<float, 3> b;
+            std::array<float, 3> c;
+            for (std::size_t e = 0; e < 3; ++e)
+            {
+                const auto& from = *points[e];
+                const auto& to = *points[e + 1];
+                a[e] = from.y - to.y;
+                b[e] = to.x - from.x;
+                c[e] = -a[e] * from.x - b[e] * from.y + (a[e] + b[e]) / 2.0F;
+            }
+
+            // the depth plane, moved to the corner of the pixel where it is the farthest
+            const auto depthX = ((p1.z - p0.z) * (p2.y - p0.y) - (p2.z - p0.z) * (p1.y - p0.y)) / area;
+            const auto depthY = ((p2.z - p0.z) * (p1.x - p0.x) - (p1.z - p0.z) * (p2.x - p0.x)) / area;
+            const auto depth0 = p0.z - depthX * p0.x - depthY * p0.y + std::max(depthX, 0.0F) + std::max(depthY, 0.0F);
+
+            for (auto y = static_cast<std::size_t>(minY); y < static_cast<std::size_t>(maxY); ++y)
+            {
+                const auto row = &depths[y * width];
+                const auto fy = static_cast<float>(y);
+
+                for (auto x = static_cast<std::size_t>(minX); x < static_cast<std::size_t>(maxX); ++x)
+                {
+                    const auto fx = static_cast<float>(x);
+                    const auto inside = a[0] * fx + b[0] * fy + c[0] >= 0.0F &&
+                        a[1] * fx + b[1] * fy + c[1] >= 0.0F &&
+                        a[2] * fx + b[2] * fy + c[2] >= 0.0F;
+                    const auto depth = depth0 + depthX * fx + depthY * fy;
+                    row[x] = inside ? std::min(row[x], depth) : row[x];
+                }
+            }
+        }
+
+        std::size_t width = 0;
+        std::size_t height = 0;
+        std::vector<float> depths;
+        std::vector<ScreenPosition> positions;
+    };
+}
+
+#endif
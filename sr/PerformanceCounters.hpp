@@ -0,0 +1,194 @@
+//
+//  SoftwareRenderer
+//
+
+#ifndef SR_PERFORMANCECOUNTERS_HPP
+#define SR_PERFORMANCECOUNTERS_HPP
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#if defined(__linux__)
+#  include <cstring>
+#  include <linux/perf_event.h>
+#  include <sys/syscall.h>
+#  include <unistd.h>
+#endif
+
+namespace sr
+{
+    // hardware counters of the calling thread, opened with perf_event_open on Linux,
+    // the counters that the platform, the kernel or its perf_event_paranoid setting do not allow stay unavailable
+    class PerformanceCounters final
+    {
+    public:
+        enum class Event
+        {
+            cycles,
+            instructions,
+            l1dMisses, // L1 data cache read misses
+            llcMisses, // last level cache misses
+            branchMisses
+        };
+
+        static constexpr std::size_t eventCount = 5;
+
+        class Values final
+        {
+        public:
+            std::array<std::uint64_t, eventCount> counts{};
+            std::array<bool, eventCount> valid{};
+
+            [[nodiscard]] bool isValid(const Event event) const noexcept
+            {
+                return valid[static_cast<std::size_t>(event)];
+            }
+
+            [[nodiscard]] std::uint64_t operator[](const Event event) const noexcept
+            {
+                return counts[static_cast<std::size_t>(event)];
+            }
+
+            [[nodiscard]] bool isAnyValid() const noexcept
+            {
+                for (const auto v : valid)
+                    if (v) return true;
+                return false;
+            }
+
+            // the difference of two readings, a counter is valid only if it is valid in both
+            [[nodiscard]] Values operator-(const Values& other) const noexcept
+            {
+                Values result;
+                for (std::size_t i = 0; i < eventCount; ++i)
+                {
+                    result.valid[i] = valid[i] && other.valid[i];
+                    result.counts[i] = (result.valid[i] && counts[i] > other.counts[i]) ? counts[i] - other.counts[i] : 0;
+                }
+                return result;
+            }
+
+            // sums the deltas, a counter stays valid only if it is valid in both
+            Values& operator+=(const Values& other) noexcept
+            {
+                for (std::size_t i = 0; i < eventCount; ++i)
+                {
+                    valid[i] = valid[i] && other.valid[i];
+                    counts[i] += other.counts[i];
+                }
+                return *this;
+            }
+        };
+
+        PerformanceCounters() noexcept
+        {
+#if defined(__linux__)
+            for (std::size_t i = 0; i < eventCount; ++i)
+            {
+                perf_event_attr attributes;
+                std::memset(&attributes, 0, sizeof(attributes));
+                attributes.size = sizeof(attributes);
+                attributes.exclude_kernel = 1;
+                attributes.exclude_hv = 1;
+                attributes.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+                switch (static_cast<Event>(i))
+                {
+                    case Event::cycles:
+                        attributes.type = PERF_TYPE_HARDWARE;
+                        attributes.config = PERF_COUNT_HW_CPU_CYCLES;
+                        break;
+                    case Event::instructions:
+                        attributes.type = PERF_TYPE_HARDWARE;
+                        attributes.config = PERF_COUNT_HW_INSTRUCTIONS;
+                        break;
+                    case Event::l1dMisses:
+                        attributes.type = PERF_TYPE_HW_CACHE;
+                        attributes.config = PERF_COUNT_HW_CACHE_L1D |
+                            (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+                            (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+                        break;
+                    case Event::llcMisses:
+                        attributes.type = PERF_TYPE_HARDWARE;
+                        attributes.config = PERF_COUNT_HW_CACHE_MISSES;
+                        break;
+                    case Event::branchMisses:
+                        attributes.type = PERF_TYPE_HARDWARE;
+                        attributes.config = PERF_COUNT_HW_BRANCH_MISSES;
+                        break;
+                }
+
+                // the counters run from now on, readings are compared with each other
+                descriptors[i] = static_cast<int>(syscall(SYS_perf_event_open, &attributes, 0, -1, -1, 0));
+            }
+#endif
+        }
+
+        ~PerformanceCounters()
+        {
+#if defined(__linux__)
+            for (const auto descriptor : descriptors)
+                if (descriptor != -1) close(descriptor);
+#endif
+        }
+
+        PerformanceCounters(const PerformanceCounters&) = delete;
+        PerformanceCounters& operator=(const PerformanceCounters&) = delete;
+        PerformanceCounters(PerformanceCounters&&) = delete;
+        PerformanceCounters& operator=(PerformanceCounters&&) = delete;
+
+        [[nodiscard]] bool isAvailable(const Event event) const noexcept
+        {
+            return descriptors[static_cast<std::size_t>(event)] != -1;
+        }
+
+        [[nodiscard]] bool isAnyAvailable() const noexcept
+        {
+            for (const auto descriptor : descriptors)
+                if (descriptor != -1) return true;
+            return false;
+        }
+
+        // the counts since the counters were opened, scaled up if the kernel had to multiplex the counters
+        [[nodiscard]] Values read() const noexcept
+        {
+            Values result;
+
+#if defined(__linux__)
+            for (std::size_t i = 0; i < eventCount; ++i)
+            {
+                if (descriptors[i] == -1) continue;
+
+                std::uint64_t data[3]; // value, time enabled, time running
+                if (::read(descriptors[i], data, sizeof(data)) != static_cast<ssize_t>(sizeof(data)) || data[2] == 0)
+                    continue;
+
+                result.counts[i] = (data[2] < data[1]) ?
+                    static_cast<std::uint64_t>(static_cast<double>(data[0]) * static_cast<double>(data[1]) / static_cast<double>(data[2])) :
+                    data[0];
+                result.valid[i] = true;
+            }
+#endif
+
+            return result;
+        }
+
+        [[nodiscard]] static const char* getName(const Event event) noexcept
+        {
+            switch (event)
+            {
+                case Event::cycles: return "cycles";
+                case Event::instructions: return "instructions";
+                case Event::l1dMisses: return "l1dMisses";
+                case Event::llcMisses: return "llcMisses";
+                case Event::branchMisses: return "branchMisses";
+                default: return "unknown";
+            }
+        }
+
+    private:
+        std::array<int, eventCount> descriptors{-1, -1, -1, -1, -1};
+    };
+}
+
+#endif
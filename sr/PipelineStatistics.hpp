@@ -0,0 +1,62 @@
+//
+//  SoftwareRenderer
+//
+
+#ifndef SR_PIPELINESTATISTICS_HPP
+#define SR_PIPELINESTATISTICS_HPP
+
+#include <cstdint>
+
+// define SR_PIPELINE_STATISTICS to 1 to compile the counters into the pipeline,
+// otherwise the statistics stay zero and cost nothing
+#ifndef SR_PIPELINE_STATISTICS
+#  define SR_PIPELINE_STATISTICS 0
+#endif
+
+namespace sr
+{
+    constexpr bool pipelineStatisticsEnabled = SR_PIPELINE_STATISTICS != 0;
+
+    class PipelineStatistics final
+    {
+    public:
+        std::uint64_t objectsCulled = 0; // draws or instances with the bounding volume outside of the view or occluded
+        std::uint64_t clustersCulled = 0; // outside of the view, facing away from the camera or occluded
+        std::uint64_t vertexShaderInvocations = 0;
+        std::uint64_t trianglesSubmitted = 0;
+        std::uint64_t trianglesCulled = 0; // outside of the scissor rectangle, back-facing, degenerate or not finite
+        std::uint64_t trianglesClipped = 0; // bounding box cut by the scissor rectangle or the render target
+        std::uint64_t pixelsVisited = 0; // pixels of the bounding boxes that were tested against the edges
+        std::uint64_t pixelsCovered = 0; // pixels with at least one sample inside of the triangle
+        std::uint64_t depthTestsPassed = 0; // samples
+        std::uint64_t depthTestsFailed = 0; // samples
+        std::uint64_t fragmentShaderInvocations = 0;
+        std::uint64_t pixelsBlended = 0;
+
+        PipelineStatistics& operator+=(const PipelineStatistics& other) noexcept
+        {
+            objectsCulled += other.objectsCulled;
+            clustersCulled += other.clustersCulled;
+            vertexShaderInvocations += other.vertexShaderInvocations;
+            trianglesSubmitted += other.trianglesSubmitted;
+            trianglesCulled += other.trianglesCulled;
+            trianglesClipped += other.trianglesClipped;
+            pixelsVisited += other.pixelsVisited;
+            pixelsCovered += other.pixelsCovered;
+            depthTestsPassed += other.depthTestsPassed;
+            depthTestsFailed += other.depthTestsFailed;
+            fragmentShaderInvocations += other.fragmentShaderInvocations;
+            pixelsBlended += other.pixelsBlended;
+            return *this;
+        }
+
+        [[nodiscard]] PipelineStatistics operator+(const PipelineStatistics& other) const noexcept
+        {
+            auto result = *this;
+            result += other;
+            return result;
+        }
+    };
+}
+
+#endif
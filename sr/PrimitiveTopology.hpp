@@ -0,0 +1,28 @@
+//
+//  SoftwareRenderer
+//
+
+#ifndef SR_PRIMITIVETOPOLOGY_HPP
+#define SR_PRIMITIVETOPOLOGY_HPP
+
+#include <cstddef>
+
+namespace sr
+{
+    enum class PrimitiveTopology
+    {
+        triangleList, // every three indices are a triangle
+        triangleStrip, // every index after the first two adds a triangle with the two indices before it
+        triangleFan // every index after the first two adds a triangle with the index before it and the first index
+    };
+
+    // the number of triangles that the indices make up, an upper bound if the primitives are restarted
+    [[nodiscard]] constexpr std::size_t getTriangleCount(const PrimitiveTopology topology,
+                                                         const std::size_t indexCount) noexcept
+    {
+        return (topology == PrimitiveTopology::triangleList) ? indexCount / 3 :
+            (indexCount > 2) ? indexCount - 2 : 0;
+    }
+}
+
+#endif
@@ -0,0 +1,81 @@
+//
+//  SoftwareRenderer
+//
+
+#ifndef SR_QUERY_HPP
+#define SR_QUERY_HPP
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+namespace sr
+{
+    enum class QueryType
+    {
+        samplesPassed, // samples of the draws that passed the depth test (all covered samples without a depth test)
+        timestamp // nanoseconds of the steady clock when a stage of the render pass completed
+    };
+
+    // written by the renderer, possibly on other threads, and read by the application without waiting,
+    // reset the query before recording the draws or the render pass that use it again
+    class Query final
+    {
+    public:
+        explicit Query(const QueryType initType) noexcept:
+            type{initType}
+        {
+        }
+
+        Query(const Query&) = delete;
+        Query& operator=(const Query&) = delete;
+
+        [[nodiscard]] QueryType getType() const noexcept { return type; }
+
+        void reset() noexcept
+        {
+            value.store(0, std::memory_order_relaxed);
+            available.store(false, std::memory_order_release);
+        }
+
+        // the render pass that writes the query has completed
+        [[nodiscard]] bool isAvailable() const noexcept
+        {
+            return available.load(std::memory_order_acquire);
+        }
+
+        // returns false and leaves the result untouched if it is not available yet
+        [[nodiscard]] bool getResult(std::uint64_t& result) const noexcept
+        {
+            if (!isAvailable()) return false;
+            result = value.load(std::memory_order_relaxed);
+            return true;
+        }
+
+        // used by the renderer
+        void addSamples(const std::uint64_t samples) noexcept
+        {
+            value.fetch_add(samples, std::memory_order_relaxed);
+        }
+
+        void writeTimestamp() noexcept
+        {
+            const auto time = std::chrono::steady_clock::now().time_since_epoch();
+            value.store(static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(time).count()),
+                        std::memory_order_relaxed);
+            complete();
+        }
+
+        void complete() noexcept
+        {
+            available.store(true, std::memory_order_release);
+        }
+
+    private:
+        QueryType type;
+        std::atomic<std::uint64_t> value{0};
+        std::atomic<bool> available{false};
+    };
+}
+
+#endif
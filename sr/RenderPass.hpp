@@ -0,0 +1,69 @@
+//
+//  SoftwareRenderer
+//
+
+#ifndef SR_RENDERPASS_HPP
+#define SR_RENDERPASS_HPP
+
+#include <cstddef>
+#include "Color.hpp"
+#include "Query.hpp"
+#include "Texture.hpp"
+#include "TextureView.hpp"
+
+namespace sr
+{
+    class RenderPass final
+    {
+    public:
+        enum class LoadAction
+        {
+            load, // keep the current contents of the attachment
+            clear, // fill the attachment with the clear value
+            dontCare // the initial contents are undefined
+        };
+
+        enum class StoreAction
+        {
+            store, // write the results back to the attachment
+            discard // the results are not needed after the pass
+        };
+
+        class ColorAttachment final
+        {
+        public:
+            Texture* texture = nullptr;
+            LoadAction loadAction = LoadAction::load;
+            StoreAction storeAction = StoreAction::store;
+            Color clearColor;
+            Texture* resolveTexture = nullptr; // receives the averaged samples of a multisampled texture
+            TextureView view; // used instead of the texture if the texture is null
+            TextureView resolveView; // used instead of the resolve texture if the resolve texture is null
+        };
+
+        class DepthAttachment final
+        {
+        public:
+            Texture* texture = nullptr; // both the texture and the view can be null if the depth is neither loaded nor stored
+            LoadAction loadAction = LoadAction::load;
+            StoreAction storeAction = StoreAction::store;
+            float clearDepth = 1.0F;
+            TextureView view; // used instead of the texture if the texture is null
+        };
+
+        ColorAttachment colorAttachment;
+        DepthAttachment depthAttachment;
+
+        // 0 renders straight into the attachments, otherwise the draws are binned
+        // and each tile is loaded, rasterized and stored on its own
+        std::size_t tileSize = 0;
+
+        // timestamp queries written when the pass starts, when the triangles of all the draws are set up
+        // (before the last draw is rasterized in immediate mode) and when the pass has finished
+        Query* beginTimestamp = nullptr;
+        Query* geometryTimestamp = nullptr;
+        Query* endTimestamp = nullptr;
+    };
+}
+
+#endif
@@ -8,177 +8,1368 @@
 #include <cassert>
 #include <algorithm>
 #include <array>
+#include <cmath>
+#include <iterator>
 #include <limits>
+#include <memory>
+#include <mutex>
+#include <type_traits>
+#include <vector>
 #include "BlendState.hpp"
+#include "Cluster.hpp"
 #include "Color.hpp"
+#include "ConstantBuffer.hpp"
+#include "CullMode.hpp"
 #include "DepthState.hpp"
+#include "DrawCall.hpp"
+#include "Frustum.hpp"
+#include "IndexBufferView.hpp"
+#include "Instance.hpp"
+#include "JobSystem.hpp"
 #include "Matrix.hpp"
+#include "OcclusionBuffer.hpp"
+#include "PipelineStatistics.hpp"
+#include "PrimitiveTopology.hpp"
+#include "Query.hpp"
 #include "Rect.hpp"
 #include "RenderError.hpp"
+#include "RenderPass.hpp"
 #include "Sampler.hpp"
 #include "Shader.hpp"
 #include "Texture.hpp"
+#include "TextureView.hpp"
+#include "Trace.hpp"
 #include "Vector.hpp"
 #include "Vertex.hpp"
+#include "VertexLayout.hpp"
 
 namespace sr
 {
-    inline void drawTriangles(Texture& frameBuffer,
-                              Texture& depthBuffer,
-                              VertexShader vertexShader,
-                              FragmentShader fragmentShader,
-                              const std::array<const Sampler*, 2>& samplers,
-                              const std::array<const Texture*, 2>& textures,
-                              const Rect<float>& viewport,
-                              const Rect<float>& scissorRect,
-                              const BlendState& blendState,
-                              const DepthState& depthState,
-                              const std::vector<std::size_t>& indices,
-                              const std::vector<Vertex>& vertices,
-                              const Matrix<float, 4>& modelViewProjection)
+    namespace detail
     {
-        const auto frameBufferData = reinterpret_cast<std::uint32_t*>(frameBuffer.getData().data());
-        const auto depthBufferData = reinterpret_cast<float*>(depthBuffer.getData().data());
+        template <class Function>
+        void parallelFor(JobSystem* jobSystem,
+                         const std::size_t begin,
+                         const std::size_t end,
+                         const std::size_t grainSize,
+                         const Function& function)
+        {
+            if (jobSystem)
+                jobSystem->parallelFor(begin, end, grainSize, function);
+            else if (begin < end)
+                function(begin, end);
+        }
 
-        for (std::size_t i = 0; i + 2 < indices.size(); i += 3)
+        // rectangular part of an attachment or of a tile buffer
+        template <typename T> class Surface final
         {
-            const std::array<VertexShaderOutput, 3> vsOutputs{
-                vertexShader(modelViewProjection, vertices[indices[i + 0]]),
-                vertexShader(modelViewProjection, vertices[indices[i + 1]]),
-                vertexShader(modelViewProjection, vertices[indices[i + 2]])
-            };
+        public:
+            T* data = nullptr;
+            std::size_t pitch = 0; // in pixels
+            std::size_t x = 0;
+            std::size_t y = 0;
+            std::size_t width = 0;
+            std::size_t height = 0;
+            std::size_t sampleCount = 1;
 
-            std::array<Vector<float, 4>, 3> ndcPositions{
-                vsOutputs[0].position,
-                vsOutputs[1].position,
-                vsOutputs[2].position
-            };
+            [[nodiscard]] T& at(const std::size_t pixelX,
+                                const std::size_t pixelY,
+                                const std::size_t sample = 0) const noexcept
+            {
+                return data[((pixelY - y) * pitch + (pixelX - x)) * sampleCount + sample];
+            }
+        };
 
-            // transform to normalized device coordinates
-            for (sr::Vector<float, 4>& ndcPosition : ndcPositions)
-                ndcPosition /= ndcPosition.v[3];
+        // tile buffers and rasterization counters of one tile job
+        class TileScratch final
+        {
+        public:
+            std::vector<std::uint32_t> colorTile;
+            std::vector<float> depthTile;
+            std::vector<PipelineStatistics> statistics;
+        };
 
-            std::array<Vector<float, 2>, 3> viewportPositions{
-                Vector<float, 2>{ndcPositions[0].v[0], ndcPositions[0].v[1]},
-                Vector<float, 2>{ndcPositions[1].v[0], ndcPositions[1].v[1]},
-                Vector<float, 2>{ndcPositions[2].v[0], ndcPositions[2].v[1]}
-            };
+        // the tile jobs of a render pass can run on any thread that waits on the job system, including the threads
+        // of other render passes, so a job takes buffers that no other job is using and returns them when it is done
+        class TileScratchPool final
+        {
+        public:
+            [[nodiscard]] TileScratch& acquire()
+            {
+                std::unique_lock lock{mutex};
+                if (free.empty())
+                {
+                    scratches.push_back(std::make_unique<TileScratch>());
+                    return *scratches.back();
+                }
 
-            Vector<float, 2> screenMin{
-                std::numeric_limits<float>::infinity(),
-                std::numeric_limits<float>::infinity()
+                auto& scratch = *free.back();
+                free.pop_back();
+                return scratch;
+            }
+
+            void release(TileScratch& scratch)
+            {
+                std::unique_lock lock{mutex};
+                free.push_back(&scratch);
+            }
+
+            // only after all the jobs are done
+            [[nodiscard]] const std::vector<std::unique_ptr<TileScratch>>& getScratches() const noexcept { return scratches; }
+
+        private:
+            std::mutex mutex;
+            std::vector<std::unique_ptr<TileScratch>> scratches;
+            std::vector<TileScratch*> free;
+        };
+
+        // sample offsets from the pixel position (standard Direct3D patterns)
+        [[nodiscard]] inline const Vector<float, 2>* getSamplePositions(const std::size_t sampleCount)
+        {
+            static const Vector<float, 2> positions1[] = {
+                Vector<float, 2>{0.0F, 0.0F}
+            };
+            static const Vector<float, 2> positions2[] = {
+                Vector<float, 2>{4.0F / 16.0F, 4.0F / 16.0F}, Vector<float, 2>{-4.0F / 16.0F, -4.0F / 16.0F}
             };
-            Vector<float, 2> screenMax{
-                -std::numeric_limits<float>::infinity(),
-                -std::numeric_limits<float>::infinity()
+            static const Vector<float, 2> positions4[] = {
+                Vector<float, 2>{-2.0F / 16.0F, -6.0F / 16.0F}, Vector<float, 2>{6.0F / 16.0F, -2.0F / 16.0F},
+                Vector<float, 2>{-6.0F / 16.0F, 2.0F / 16.0F}, Vector<float, 2>{2.0F / 16.0F, 6.0F / 16.0F}
             };
+            static const Vector<float, 2> positions8[] = {
+                Vector<float, 2>{1.0F / 16.0F, -3.0F / 16.0F}, Vector<float, 2>{-1.0F / 16.0F, 3.0F / 16.0F},
+                Vector<float, 2>{5.0F / 16.0F, 1.0F / 16.0F}, Vector<float, 2>{-3.0F / 16.0F, -5.0F / 16.0F},
+                Vector<float, 2>{-5.0F / 16.0F, 5.0F / 16.0F}, Vector<float, 2>{-7.0F / 16.0F, -1.0F / 16.0F},
+                Vector<float, 2>{3.0F / 16.0F, 7.0F / 16.0F}, Vector<float, 2>{7.0F / 16.0F, -7.0F / 16.0F}
+            };
+
+            switch (sampleCount)
+            {
+                case 1: return positions1;
+                case 2: return positions2;
+                case 4: return positions4;
+                case 8: return positions8;
+                default: throw RenderError{"Invalid sample count"};
+            }
+        }
+
+        class Triangle final
+        {
+        public:
+            std::size_t drawIndex = 0;
+            std::array<VertexShaderOutput, 3> vsOutputs;
+            std::array<float, 3> depths{}; // z in normalized device coordinates
+            Vector<float, 2> origin; // viewport position of the first vertex
+            Vector<float, 2> v0;
+            Vector<float, 2> v1;
+            float den = 0.0F;
+            std::size_t minX = 0;
+            std::size_t minY = 0;
+            std::size_t maxX = 0;
+            std::size_t maxY = 0;
+        };
+
+        // vertices and triangles per job of the geometry stages
+        constexpr std::size_t vertexBatchSize = 1024;
+        constexpr std::size_t triangleBatchSize = 1024;
+
+        [[nodiscard]] inline std::size_t getVertexCount(const DrawCall& drawCall) noexcept
+        {
+            return drawCall.vertexLayout ? drawCall.vertexCount :
+                drawCall.vertices ? drawCall.vertices->size() : 0;
+        }
+
+        // vertices [first, last) that the indices of a draw reference, only these are shaded
+        class VertexRange final
+        {
+        public:
+            std::size_t first = 0;
+            std::size_t last = 0;
+        };
+
+        // validateDrawCall checks that the range is inside of the vertices of the draw
+        [[nodiscard]] inline VertexRange getVertexRange(const DrawCall& drawCall) noexcept
+        {
+            const auto restart = drawCall.primitiveRestart && drawCall.topology != PrimitiveTopology::triangleList;
+            const auto size = drawCall.indices.getSize();
+
+            return drawCall.indices.visit([size, restart](const auto indices) {
+                using Index = std::remove_cv_t<std::remove_pointer_t<decltype(indices)>>;
+                constexpr auto restartIndex = std::numeric_limits<Index>::max();
+
+                auto minIndex = std::numeric_limits<Index>::max();
+                Index maxIndex = 0;
+                bool found = false;
+                for (std::size_t i = 0; i < size; ++i)
+                {
+                    const auto index = indices[i];
+                    if (restart && index == restartIndex) continue;
+                    minIndex = std::min(minIndex, index);
+                    maxIndex = std::max(maxIndex, index);
+                    found = true;
+                }
+
+                return found ? VertexRange{minIndex, std::size_t{maxIndex} + 1} : VertexRange{};
+            });
+        }
+
+        // positions of the restart indices of a strip or fan in ascending order, empty without primitive restart,
+        // found once per draw, so that every batch of triangles finds the start of its first primitive by a binary search
+        [[nodiscard]] inline std::vector<std::size_t> getRestartPositions(const DrawCall& drawCall)
+        {
+            std::vector<std::size_t> positions;
+            if (!drawCall.primitiveRestart || drawCall.topology == PrimitiveTopology::triangleList)
+                return positions;
+
+            drawCall.indices.visit([&](const auto indices) {
+                using Index = std::remove_cv_t<std::remove_pointer_t<decltype(indices)>>;
+                constexpr auto restartIndex = std::numeric_limits<Index>::max();
+
+                for (std::size_t i = 0; i < drawCall.indices.getSize(); ++i)
+                    if (indices[i] == restartIndex) positions.push_back(i);
+            });
+
+            return positions;
+        }
+
+        inline void validateDrawCall(const DrawCall& drawCall)
+        {
+            if (drawCall.customVaryingCount > maxCustomVaryings)
+                throw RenderError{"Too many custom varyings"};
+
+            // the samples of a draw can only be counted into and tested against samples passed queries
+            if ((drawCall.query && drawCall.query->getType() != QueryType::samplesPassed) ||
+                (drawCall.predicate && drawCall.predicate->getType() != QueryType::samplesPassed))
+                throw RenderError{"Invalid query type"};
+
+            if (drawCall.clusters)
+            {
+                if (drawCall.topology != PrimitiveTopology::triangleList)
+                    throw RenderError{"Clusters need a triangle list"};
+
+                for (const auto& cluster : *drawCall.clusters)
+                    if (cluster.firstIndex % 3 != 0 || cluster.indexCount % 3 != 0 ||
+                        cluster.firstIndex + cluster.indexCount > drawCall.indices.getSize())
+                        throw RenderError{"Invalid cluster"};
+            }
+
+            if (!drawCall.vertexLayout && !drawCall.vertices)
+                throw RenderError{"No vertices"};
+
+            // the restart indices of strips and fans are not vertices
+            if (getVertexRange(drawCall).last > getVertexCount(drawCall))
+                throw RenderError{"Index out of range"};
+
+            if (!drawCall.vertexLayout) return;
+
+            for (const auto& element : drawCall.vertexLayout->elements)
+            {
+                if (element.stream >= maxVertexStreams)
+                    throw RenderError{"Invalid vertex stream"};
+
+                const auto formatSize = getVertexFormatSize(element.format);
+                if (formatSize == 0)
+                    throw RenderError{"Invalid vertex format"};
+
+                // a stride of 0 gives every vertex the same value
+                const auto& stream = drawCall.vertexStreams[element.stream];
+                if (drawCall.vertexCount && !stream.data)
+                    throw RenderError{"Missing vertex stream"};
+
+                if (stream.stride != 0 && stream.stride < element.offset + formatSize)
+                    throw RenderError{"Vertex element does not fit into the stride"};
+
+                // the element of the last vertex must be inside of the stream
+                if (drawCall.vertexCount &&
+                    stream.size < (drawCall.vertexCount - 1) * stream.stride + element.offset + formatSize)
+                    throw RenderError{"Vertex stream is too small"};
+            }
+        }
+
+        // an attribute of the vertex layout that the vertex shader reads
+        class VertexFetch final
+        {
+        public:
+            VertexAttribute attribute;
+            VertexFormat format;
+            const std::uint8_t* data; // the attribute of the first vertex
+            std::size_t stride;
+        };
+
+        // reads only the attributes that the vertex shader declared, the others keep their default values
+        inline void fetchVertex(const std::array<VertexFetch, vertexAttributeCount>& fetches,
+                                const std::size_t fetchCount,
+                                const std::size_t index,
+                                Vertex& vertex) noexcept
+        {
+            for (std::size_t f = 0; f < fetchCount; ++f)
+            {
+                const auto& fetch = fetches[f];
+                const auto value = readVertexElement(fetch.format, fetch.data + index * fetch.stride);
+
+                switch (fetch.attribute)
+                {
+                    case VertexAttribute::position:
+                        vertex.position = value;
+                        break;
+                    case VertexAttribute::color:
+                        vertex.color = Color{value.v[0], value.v[1], value.v[2], value.v[3]};
+                        break;
+                    case VertexAttribute::texCoord0:
+                        vertex.texCoords[0] = Vector<float, 2>{value.v[0], value.v[1]};
+                        break;
+                    case VertexAttribute::texCoord1:
+                        vertex.texCoords[1] = Vector<float, 2>{value.v[0], value.v[1]};
+                        break;
+                    case VertexAttribute::normal:
+                        vertex.normal = Vector<float, 3>{value.v[0], value.v[1], value.v[2]};
+                        break;
+                }
+            }
+        }
+
+        // every vertex of the range is shaded once per instance, no matter how many triangles share it,
+        // vsOutputs and the vertex mask start at the first vertex of the range,
+        // with a vertex mask only the vertices that it marks are shaded
+        inline void shadeVertices(const DrawCall& drawCall,
+                                  const Matrix<float, 4>& modelViewProjection,
+                                  const Instance& instance,
+                                  const VertexRange& vertexRange,
+                                  const std::vector<std::uint8_t>* vertexMask,
+                                  std::vector<VertexShaderOutput>& vsOutputs,
+                                  JobSystem* jobSystem,
+                                  PipelineStatistics* statistics)
+        {
+            const auto firstVertex = vertexRange.first;
+            vsOutputs.resize(vertexRange.last - firstVertex);
+
+            if constexpr (pipelineStatisticsEnabled)
+                if (statistics)
+                    statistics->vertexShaderInvocations += vertexMask ?
+                        static_cast<std::size_t>(std::count(vertexMask->begin(), vertexMask->end(), 1)) :
+                        vsOutputs.size();
+
+            if (!drawCall.vertexLayout)
+            {
+                const auto& vertices = *drawCall.vertices;
+
+                parallelFor(jobSystem, 0, vsOutputs.size(), vertexBatchSize, [&](const std::size_t begin, const std::size_t end) {
+                    TraceScope trace{"vertex"};
+                    for (auto v = begin; v < end; ++v)
+                        if (!vertexMask || (*vertexMask)[v])
+                            vsOutputs[v] = drawCall.vertexShader(modelViewProjection, vertices[firstVertex + v], instance, drawCall.constants);
+                });
+                return;
+            }
+
+            std::array<VertexFetch, vertexAttributeCount> fetches;
+            std::size_t fetchCount = 0;
 
-            for (auto& viewportPosition : viewportPositions)
+            for (const auto& element : drawCall.vertexLayout->elements)
+                if ((drawCall.vertexShaderInputs & getMask(element.attribute)) && fetchCount < fetches.size())
+                {
+                    const auto& stream = drawCall.vertexStreams[element.stream];
+                    fetches[fetchCount++] = VertexFetch{
+                        element.attribute,
+                        element.format,
+                        static_cast<const std::uint8_t*>(stream.data) + element.offset,
+                        stream.stride
+                    };
+                }
+
+            parallelFor(jobSystem, 0, vsOutputs.size(), vertexBatchSize, [&](const std::size_t begin, const std::size_t end) {
+                TraceScope trace{"vertex"};
+                for (auto v = begin; v < end; ++v)
+                {
+                    if (vertexMask && !(*vertexMask)[v]) continue;
+
+                    Vertex vertex;
+                    fetchVertex(fetches, fetchCount, firstVertex + v, vertex);
+                    vsOutputs[v] = drawCall.vertexShader(modelViewProjection, vertex, instance, drawCall.constants);
+                }
+            });
+        }
+
+        // assembles the triangles [firstTriangle, lastTriangle) of the draw and appends the visible ones,
+        // indices are the indices of the draw in their own type, vsOutputs start at the vertex firstVertex,
+        // the triangle t of a strip or a fan starts at the index t, unless a restart index is in its way,
+        // restartPositions are the positions of the restart indices of the draw,
+        // triangles of a mesh inside of the frustum are not tested against the scissor rectangle if it covers the render target
+        template <typename Index>
+        void setupTriangles(const DrawCall& drawCall,
+                            const std::size_t drawIndex,
+                            const std::size_t width,
+                            const std::size_t height,
+                            const std::size_t sampleCount,
+                            const std::vector<VertexShaderOutput>& vsOutputs,
+                            const std::size_t firstVertex,
+                            const Index* indices,
+                            const std::vector<std::size_t>& restartPositions,
+                            const std::size_t firstTriangle,
+                            const std::size_t lastTriangle,
+                            const bool insideFrustum,
+                            std::vector<Triangle>& triangles,
+                            PipelineStatistics* statistics)
+        {
+            TraceScope trace{"setup"};
+
+            const auto& viewport = drawCall.viewport;
+            const auto& scissorRect = drawCall.scissorRect;
+
+            // scissor rectangle is in normalized render target coordinates
+            const auto lastX = static_cast<float>(width - 1);
+            const auto lastY = static_cast<float>(height - 1);
+            const auto scissorMinX = static_cast<std::size_t>(std::clamp(scissorRect.position.v[0] * width, 0.0F, lastX));
+            const auto scissorMinY = static_cast<std::size_t>(std::clamp(scissorRect.position.v[1] * height, 0.0F, lastY));
+            const auto scissorMaxX = static_cast<std::size_t>(std::clamp(std::ceil((scissorRect.position.v[0] + scissorRect.size.v[0]) * width) - 1.0F, 0.0F, lastX));
+            const auto scissorMaxY = static_cast<std::size_t>(std::clamp(std::ceil((scissorRect.position.v[1] + scissorRect.size.v[1]) * height) - 1.0F, 0.0F, lastY));
+
+            // the bounding boxes are still clamped to the render target, so that skipping the tests only costs
+            // the rasterization of the slivers at the edges of the viewport
+            const auto clipping = !insideFrustum ||
+                scissorMinX > 0 || scissorMinY > 0 ||
+                scissorMaxX < width - 1 || scissorMaxY < height - 1;
+
+            // samples can lie up to half a pixel away from the pixel position
+            const auto sampleExtent = (sampleCount > 1) ? 1.0F : 0.0F;
+
+            const auto cullMode = drawCall.cullMode;
+            const auto topology = drawCall.topology;
+            const auto restart = drawCall.primitiveRestart && topology != PrimitiveTopology::triangleList;
+            constexpr auto restartIndex = std::numeric_limits<Index>::max();
+
+            // the first index of the strip or fan that the first triangle belongs to, after the last restart index before it
+            std::size_t primitiveStart = 0;
+            if (restart)
+            {
+                const auto next = std::lower_bound(restartPositions.begin(), restartPositions.end(), firstTriangle);
+                if (next != restartPositions.begin()) primitiveStart = *std::prev(next) + 1;
+            }
+
+            PipelineStatistics counters;
+
+            for (auto t = firstTriangle; t < lastTriangle; ++t)
+            {
+                if (restart)
+                {
+                    if (indices[t] == restartIndex)
+                    {
+                        primitiveStart = t + 1;
+                        continue;
+                    }
+
+                    if (indices[t + 1] == restartIndex || indices[t + 2] == restartIndex)
+                        continue;
+                }
+
+                if constexpr (pipelineStatisticsEnabled) ++counters.trianglesSubmitted;
+
+                // every vertex is shaded once, so the triangles of strips and fans share the shaded vertices
+                std::size_t i0 = t * 3;
+                std::size_t i1 = i0 + 1;
+                std::size_t i2 = i0 + 2;
+
+                if (topology == PrimitiveTopology::triangleStrip)
+                {
+                    // every other triangle of a strip is flipped to keep the winding of the first one
+                    const auto odd = ((t - primitiveStart) % 2) != 0;
+                    i0 = odd ? t + 1 : t;
+                    i1 = odd ? t : t + 1;
+                    i2 = t + 2;
+                }
+                else if (topology == PrimitiveTopology::triangleFan)
+                {
+                    i0 = primitiveStart;
+                    i1 = t + 1;
+                    i2 = t + 2;
+                }
+
+                Triangle triangle;
+                triangle.drawIndex = drawIndex;
+                triangle.vsOutputs = {
+                    vsOutputs[indices[i0] - firstVertex],
+                    vsOutputs[indices[i1] - firstVertex],
+                    vsOutputs[indices[i2] - firstVertex]
+                };
+
+                std::array<Vector<float, 2>, 3> viewportPositions;
+
+                Vector<float, 2> screenMin{
+                    std::numeric_limits<float>::infinity(),
+                    std::numeric_limits<float>::infinity()
+                };
+                Vector<float, 2> screenMax{
+                    -std::numeric_limits<float>::infinity(),
+                    -std::numeric_limits<float>::infinity()
+                };
+
+                bool finite = true;
+
+                for (std::size_t v = 0; v < 3; ++v)
+                {
+                    // transform to normalized device coordinates
+                    auto ndcPosition = triangle.vsOutputs[v].position;
+                    ndcPosition /= ndcPosition.v[3];
+                    triangle.depths[v] = ndcPosition.v[2];
+
+                    // transform to viewport coordinates
+                    auto& viewportPosition = viewportPositions[v];
+                    viewportPosition.v[0] = ndcPosition.v[0] * viewport.size.v[0] / 2.0F + viewport.position.v[0] + viewport.size.v[0] / 2.0F; // xndc * width / 2 + x + width / 2
+                    viewportPosition.v[1] = ndcPosition.v[1] * viewport.size.v[1] / 2.0F + viewport.position.v[1] + viewport.size.v[1] / 2.0F;  // yndc * height / 2 + y + height / 2
+
+                    if (!std::isfinite(viewportPosition.v[0]) || !std::isfinite(viewportPosition.v[1]))
+                        finite = false;
+
+                    if (viewportPosition.v[0] < screenMin.v[0]) screenMin.v[0] = viewportPosition.v[0];
+                    if (viewportPosition.v[0] > screenMax.v[0]) screenMax.v[0] = viewportPosition.v[0];
+                    if (viewportPosition.v[1] < screenMin.v[1]) screenMin.v[1] = viewportPosition.v[1];
+                    if (viewportPosition.v[1] > screenMax.v[1]) screenMax.v[1] = viewportPosition.v[1];
+                }
+
+                screenMin -= Vector<float, 2>{sampleExtent, sampleExtent};
+                screenMax += Vector<float, 2>{sampleExtent, sampleExtent};
+
+                if (!finite || (clipping &&
+                    (screenMax.v[0] < static_cast<float>(scissorMinX) || screenMin.v[0] > static_cast<float>(scissorMaxX) ||
+                    screenMax.v[1] < static_cast<float>(scissorMinY) || screenMin.v[1] > static_cast<float>(scissorMaxY))))
+                {
+                    if constexpr (pipelineStatisticsEnabled) ++counters.trianglesCulled;
+                    continue; // outside of the scissor rectangle
+                }
+
+                triangle.origin = viewportPositions[0];
+                triangle.v0 = viewportPositions[1] - viewportPositions[0];
+                triangle.v1 = viewportPositions[2] - viewportPositions[0];
+                triangle.den = triangle.v0.v[0] * triangle.v1.v[1] - triangle.v1.v[0] * triangle.v0.v[1];
+
+                if (triangle.den == 0.0F)
+                {
+                    if constexpr (pipelineStatisticsEnabled) ++counters.trianglesCulled;
+                    continue; // degenerate triangle
+                }
+
+                // counter-clockwise triangles have a positive determinant
+                if ((cullMode == CullMode::back && triangle.den < 0.0F) ||
+                    (cullMode == CullMode::front && triangle.den > 0.0F))
+                {
+                    if constexpr (pipelineStatisticsEnabled) ++counters.trianglesCulled;
+                    continue;
+                }
+
+                if constexpr (pipelineStatisticsEnabled)
+                    if (clipping &&
+                        (screenMin.v[0] < static_cast<float>(scissorMinX) || screenMax.v[0] > static_cast<float>(scissorMaxX) ||
+                        screenMin.v[1] < static_cast<float>(scissorMinY) || screenMax.v[1] > static_cast<float>(scissorMaxY)))
+                        ++counters.trianglesClipped;
+
+                triangle.minX = std::max(static_cast<std::size_t>(std::clamp(screenMin.v[0], 0.0F, lastX)), scissorMinX);
+                triangle.minY = std::max(static_cast<std::size_t>(std::clamp(screenMin.v[1], 0.0F, lastY)), scissorMinY);
+                triangle.maxX = std::min(static_cast<std::size_t>(std::clamp(screenMax.v[0], 0.0F, lastX)), scissorMaxX);
+                triangle.maxY = std::min(static_cast<std::size_t>(std::clamp(screenMax.v[1], 0.0F, lastY)), scissorMaxY);
+
+                triangles.push_back(triangle);
+            }
+
+            if constexpr (pipelineStatisticsEnabled)
+                if (statistics) *statistics += counters;
+        }
+
+        // triangles [first, last) of the draw, of a cluster or of a batch of a draw without clusters
+        class TriangleRange final
+        {
+        public:
+            std::size_t first;
+            std::size_t last;
+            bool insideFrustum;
+        };
+
+        // runs the geometry stages of one instance of the draw, the triangles are appended in the index order
+        // regardless of how the work was split between the threads, nothing is shaded if the bounding volume is outside of the view
+        // or occluded and only the vertices of the visible clusters are shaded
+        inline void setupInstance(const DrawCall& drawCall,
+                                  const std::size_t drawIndex,
+                                  const std::size_t width,
+                                  const std::size_t height,
+                                  const std::size_t sampleCount,
+                                  const Instance& instance,
+                                  const VertexRange& vertexRange,
+                                  const std::vector<std::size_t>& restartPositions,
+                                  std::vector<VertexShaderOutput>& vsOutputs,
+                                  std::vector<Triangle>& triangles,
+                                  JobSystem* jobSystem,
+                                  PipelineStatistics* statistics)
+        {
+            const auto triangleCount = getTriangleCount(drawCall.topology, drawCall.indices.getSize());
+            const auto modelViewProjection = drawCall.modelViewProjection * instance.transform;
+            const Frustum frustum{modelViewProjection};
+
+            auto containment = Containment::intersecting;
+            if (drawCall.bounds.type != BoundingVolume::Type::none)
+            {
+                containment = frustum.getContainment(drawCall.bounds);
+
+                if (containment == Containment::outside ||
+                    (drawCall.occlusionBuffer && !drawCall.occlusionBuffer->isVisible(drawCall.bounds, modelViewProjection)))
+                {
+                    if constexpr (pipelineStatisticsEnabled)
+                        if (statistics)
+                        {
+                            ++statistics->objectsCulled;
+                            statistics->trianglesSubmitted += triangleCount;
+                            statistics->trianglesCulled += triangleCount;
+                        }
+                    return;
+                }
+            }
+
+            std::vector<TriangleRange> ranges;
+            std::vector<std::uint8_t> vertexMask;
+
+            if (drawCall.clusters)
             {
-                // transform to viewport coordinates
-                viewportPosition.v[0] = viewportPosition.v[0] * viewport.size.v[0] / 2.0F + viewport.position.v[0] + viewport.size.v[0] / 2.0F; // xndc * width / 2 + x + width / 2
-                viewportPosition.v[1] = viewportPosition.v[1] * viewport.size.v[1] / 2.0F + viewport.position.v[1] + viewport.size.v[1] / 2.0F;  // yndc * height / 2 + y + height / 2
-                //viewportPosition.v[2] = viewportPosition.v[2] * (1.0F - 0.0F) / 2.0F + (1.0F + 0.0F) / 2.0F; // zndc * (far - near) / 2 + (far + near) / 2
+                const auto projectionCenter = getProjectionCenter(modelViewProjection);
+
+                for (const auto& cluster : *drawCall.clusters)
+                {
+                    // the clusters of a draw inside of the view are inside too
+                    const auto sphere = BoundingVolume::sphere(cluster.center, cluster.radius);
+                    const auto clusterContainment = (containment == Containment::inside) ? Containment::inside :
+                        frustum.getContainment(sphere);
+
+                    if (clusterContainment == Containment::outside ||
+                        isConeCulled(cluster, projectionCenter, drawCall.cullMode) ||
+                        (drawCall.occlusionBuffer && !drawCall.occlusionBuffer->isVisible(sphere, modelViewProjection)))
+                    {
+                        if constexpr (pipelineStatisticsEnabled)
+                            if (statistics)
+                            {
+                                ++statistics->clustersCulled;
+                                statistics->trianglesSubmitted += cluster.indexCount / 3;
+                                statistics->trianglesCulled += cluster.indexCount / 3;
+                            }
+                        continue;
+                    }
+
+                    ranges.push_back(TriangleRange{
+                        cluster.firstIndex / 3,
+                        (cluster.firstIndex + cluster.indexCount) / 3,
+                        clusterContainment == Containment::inside
+                    });
+                }
 
-                if (viewportPosition.v[0] < screenMin.v[0]) screenMin.v[0] = viewportPosition.v[0];
-                if (viewportPosition.v[0] > screenMax.v[0]) screenMax.v[0] = viewportPosition.v[0];
-                if (viewportPosition.v[1] < screenMin.v[1]) screenMin.v[1] = viewportPosition.v[1];
-                if (viewportPosition.v[1] > screenMax.v[1]) screenMax.v[1] = viewportPosition.v[1];
+                if (ranges.empty()) return;
+
+                // the vertices that the visible clusters use
+                if (ranges.size() < drawCall.clusters->size())
+                {
+                    vertexMask.resize(vertexRange.last - vertexRange.first);
+                    drawCall.indices.visit([&](const auto indices) {
+                        for (const auto& range : ranges)
+                            for (auto i = range.first * 3; i < range.last * 3; ++i)
+                                vertexMask[indices[i] - vertexRange.first] = 1;
+                    });
+                }
+            }
+            else
+            {
+                // a single range if the triangles are not split between the threads
+                const auto rangeSize = jobSystem ? triangleBatchSize : std::max(triangleCount, std::size_t{1});
+                for (std::size_t first = 0; first < triangleCount; first += rangeSize)
+                    ranges.push_back(TriangleRange{
+                        first,
+                        std::min(first + rangeSize, triangleCount),
+                        containment == Containment::inside
+                    });
             }
 
-            screenMin.v[0] = std::clamp(screenMin.v[0], 0.0F, static_cast<float>(frameBuffer.getWidth() - 1) * scissorRect.position.v[0]);
-            screenMax.v[0] = std::clamp(screenMax.v[0], 0.0F, static_cast<float>(frameBuffer.getWidth() - 1) * (scissorRect.position.v[0] + scissorRect.size.v[0]));
-            screenMin.v[1] = std::clamp(screenMin.v[1], 0.0F, static_cast<float>(frameBuffer.getHeight() - 1) * scissorRect.position.v[1]);
-            screenMax.v[1] = std::clamp(screenMax.v[1], 0.0F, static_cast<float>(frameBuffer.getHeight() - 1) * (scissorRect.position.v[1] + scissorRect.size.v[1]));
+            shadeVertices(drawCall, modelViewProjection, instance, vertexRange, vertexMask.empty() ? nullptr : &vertexMask,
+                          vsOutputs, jobSystem, statistics);
 
-            const auto v0 = viewportPositions[1] - viewportPositions[0];
-            const auto v1 = viewportPositions[2] - viewportPositions[0];
-            const auto den = v0.v[0] * v1.v[1] - v1.v[0] * v0.v[1];
+            const auto setupRanges = [&](const std::size_t begin, const std::size_t end,
+                                         std::vector<Triangle>& output, PipelineStatistics* counters) {
+                drawCall.indices.visit([&](const auto indices) {
+                    for (auto r = begin; r < end; ++r)
+                        setupTriangles(drawCall, drawIndex, width, height, sampleCount, vsOutputs, vertexRange.first, indices, restartPositions,
+                                       ranges[r].first, ranges[r].last, ranges[r].insideFrustum, output, counters);
+                });
+            };
 
-            for (auto screenY = static_cast<std::size_t>(screenMin.v[1]); screenY <= static_cast<std::size_t>(screenMax.v[1]); ++screenY)
-                for (auto screenX = static_cast<std::size_t>(screenMin.v[0]); screenX <= static_cast<std::size_t>(screenMax.v[0]); ++screenX)
+            // consecutive ranges are grouped into batches of about triangleBatchSize triangles
+            std::vector<std::size_t> batchStarts;
+            std::size_t batchTriangleCount = triangleBatchSize;
+            for (std::size_t r = 0; r < ranges.size(); ++r)
+            {
+                if (batchTriangleCount >= triangleBatchSize)
+                {
+                    batchStarts.push_back(r);
+                    batchTriangleCount = 0;
+                }
+                batchTriangleCount += ranges[r].last - ranges[r].first;
+            }
+            batchStarts.push_back(ranges.size());
+
+            if (!jobSystem || batchStarts.size() <= 2)
+            {
+                setupRanges(0, ranges.size(), triangles, statistics);
+                return;
+            }
+
+            // every batch is assembled into its own list and the lists are concatenated in order
+            std::vector<std::vector<Triangle>> batches(batchStarts.size() - 1);
+            std::vector<PipelineStatistics> batchStatistics(statistics ? batches.size() : 0);
+
+            jobSystem->parallelFor(0, batches.size(), 1, [&](const std::size_t begin, const std::size_t end) {
+                for (auto batch = begin; batch < end; ++batch)
+                    setupRanges(batchStarts[batch], batchStarts[batch + 1], batches[batch],
+                                statistics ? &batchStatistics[batch] : nullptr);
+            });
+
+            for (const auto& counters : batchStatistics)
+                *statistics += counters;
+
+            std::size_t size = triangles.size();
+            for (const auto& batch : batches) size += batch.size();
+            triangles.reserve(size);
+
+            for (const auto& batch : batches)
+                triangles.insert(triangles.end(), batch.begin(), batch.end());
+        }
+
+        // instances per job of the geometry stages, enough to shade about a vertex batch
+        [[nodiscard]] inline std::size_t getInstanceBatchSize(const std::size_t vertexCount) noexcept
+        {
+            return std::max(vertexBatchSize / std::max(vertexCount, std::size_t{1}), std::size_t{1});
+        }
+
+        // runs the geometry stages of all the instances of the draw, the triangles are appended in the instance order
+        inline void setupTriangles(const DrawCall& drawCall,
+                                   const std::size_t drawIndex,
+                                   const std::size_t width,
+                                   const std::size_t height,
+                                   const std::size_t sampleCount,
+                                   std::vector<Triangle>& triangles,
+                                   JobSystem* jobSystem,
+                                   PipelineStatistics* statistics)
+        {
+            // conditional rendering, the draw is kept while the result of the predicate is not known
+            std::uint64_t predicateSamples;
+            if (drawCall.predicate && drawCall.predicate->getResult(predicateSamples) && predicateSamples == 0)
+                return;
+
+            const auto& scissorRect = drawCall.scissorRect;
+            const auto instanceCount = drawCall.instances ? drawCall.instances->size() : 1;
+            const auto triangleCount = getTriangleCount(drawCall.topology, drawCall.indices.getSize()) * instanceCount;
+
+            if (width == 0 || height == 0 || triangleCount == 0 ||
+                scissorRect.size.v[0] <= 0.0F || scissorRect.size.v[1] <= 0.0F)
+            {
+                // the restart indices are not looked for, so restarted strips and fans are overcounted
+                if constexpr (pipelineStatisticsEnabled)
+                    if (statistics)
+                    {
+                        statistics->trianglesSubmitted += triangleCount;
+                        statistics->trianglesCulled += triangleCount;
+                    }
+                return;
+            }
+
+            std::vector<VertexShaderOutput> vsOutputs;
+            const auto vertexRange = getVertexRange(drawCall);
+            const auto restartPositions = getRestartPositions(drawCall);
+
+            if (!drawCall.instances)
+            {
+                setupInstance(drawCall, drawIndex, width, height, sampleCount, Instance{}, vertexRange, restartPositions, vsOutputs, triangles, jobSystem, statistics);
+                return;
+            }
+
+            const auto& instances = *drawCall.instances;
+            const auto instanceBatchSize = getInstanceBatchSize(vertexRange.last - vertexRange.first);
+
+            // a few large instances are split between the threads one by one
+            if (!jobSystem || instanceCount <= instanceBatchSize || instanceCount < jobSystem->getWorkerCount())
+            {
+                for (const auto& instance : instances)
+                    setupInstance(drawCall, drawIndex, width, height, sampleCount, instance, vertexRange, restartPositions, vsOutputs, triangles, jobSystem, statistics);
+                return;
+            }
+
+            // many instances are distributed between the threads in batches that are concatenated in order
+            std::vector<std::vector<Triangle>> batches((instanceCount + instanceBatchSize - 1) / instanceBatchSize);
+            std::vector<PipelineStatistics> batchStatistics(statistics ? batches.size() : 0);
+
+            jobSystem->parallelFor(0, batches.size(), 1, [&](const std::size_t begin, const std::size_t end) {
+                std::vector<VertexShaderOutput> batchOutputs;
+                for (auto batch = begin; batch < end; ++batch)
+                    for (auto i = batch * instanceBatchSize; i < std::min((batch + 1) * instanceBatchSize, instanceCount); ++i)
+                        setupInstance(drawCall, drawIndex, width, height, sampleCount, instances[i], vertexRange, restartPositions, batchOutputs, batches[batch], nullptr,
+                                      statistics ? &batchStatistics[batch] : nullptr);
+            });
+
+            for (const auto& counters : batchStatistics)
+                *statistics += counters;
+
+            std::size_t size = triangles.size();
+            for (const auto& batch : batches) size += batch.size();
+            triangles.reserve(size);
+
+            for (const auto& batch : batches)
+                triangles.insert(triangles.end(), batch.begin(), batch.end());
+        }
+
+        // only the varyings that the fragment shader declared are interpolated
+        [[nodiscard]] inline VertexShaderOutput interpolate(const std::array<VertexShaderOutput, 3>& vsOutputs,
+                                                            const Vector<float, 3>& clip,
+                                                            const std::uint32_t inputs,
+                                                            const std::size_t customVaryingCount) noexcept
+        {
+            VertexShaderOutput psInput;
+            psInput.position = Vector<float, 4>{clip.v[0], clip.v[1], clip.v[2], 1.0F};
+
+            if (inputs & getMask(Varying::color))
+                psInput.color = Color{
+                    vsOutputs[0].color.r * clip.v[0] + vsOutputs[1].color.r * clip.v[1] + vsOutputs[2].color.r * clip.v[2],
+                    vsOutputs[0].color.g * clip.v[0] + vsOutputs[1].color.g * clip.v[1] + vsOutputs[2].color.g * clip.v[2],
+                    vsOutputs[0].color.b * clip.v[0] + vsOutputs[1].color.b * clip.v[1] + vsOutputs[2].color.b * clip.v[2],
+                    vsOutputs[0].color.a * clip.v[0] + vsOutputs[1].color.a * clip.v[1] + vsOutputs[2].color.a * clip.v[2]
+                };
+
+            if (inputs & getMask(Varying::texCoord0))
+                psInput.texCoords[0] = Vector<float, 2>{
+                    vsOutputs[0].texCoords[0].v[0] * clip.v[0] + vsOutputs[1].texCoords[0].v[0] * clip.v[1] + vsOutputs[2].texCoords[0].v[0] * clip.v[2],
+                    vsOutputs[0].texCoords[0].v[1] * clip.v[0] + vsOutputs[1].texCoords[0].v[1] * clip.v[1] + vsOutputs[2].texCoords[0].v[1] * clip.v[2]
+                };
+
+            if (inputs & getMask(Varying::texCoord1))
+                psInput.texCoords[1] = Vector<float, 2>{
+                    vsOutputs[0].texCoords[1].v[0] * clip.v[0] + vsOutputs[1].texCoords[1].v[0] * clip.v[1] + vsOutputs[2].texCoords[1].v[0] * clip.v[2],
+                    vsOutputs[0].texCoords[1].v[1] * clip.v[0] + vsOutputs[1].texCoords[1].v[1] * clip.v[1] + vsOutputs[2].texCoords[1].v[1] * clip.v[2]
+                };
+
+            if (inputs & getMask(Varying::normal))
+                psInput.normal = vsOutputs[0].normal * clip.v[0] + vsOutputs[1].normal * clip.v[1] + vsOutputs[2].normal * clip.v[2];
+
+            for (std::size_t i = 0; i < customVaryingCount; ++i)
+                psInput.varyings[i] = vsOutputs[0].varyings[i] * clip.v[0] + vsOutputs[1].varyings[i] * clip.v[1] + vsOutputs[2].varyings[i] * clip.v[2];
+
+            return psInput;
+        }
+
+        [[nodiscard]] inline std::uint32_t blend(const BlendState& blendState,
+                                                 const Color& srcColor,
+                                                 const std::uint32_t pixelValue)
+        {
+            const auto pixel = reinterpret_cast<const std::uint8_t*>(&pixelValue);
+            const Color destColor{pixel[0], pixel[1], pixel[2], pixel[3]};
+
+            // alpha blend
+            const Color resultColor{
+                getValue(blendState.colorOperation,
+                         srcColor.r * getValue(blendState.colorBlendSource, srcColor.r, srcColor.a, destColor.r, destColor.a, blendState.blendFactor.r),
+                         destColor.r * getValue(blendState.colorBlendDest, srcColor.r, srcColor.a, destColor.r, destColor.a, blendState.blendFactor.r)),
+                getValue(blendState.colorOperation,
+                         srcColor.g * getValue(blendState.colorBlendSource, srcColor.g, srcColor.a, destColor.g, destColor.a, blendState.blendFactor.g),
+                         destColor.g * getValue(blendState.colorBlendDest, srcColor.g, srcColor.a, destColor.g, destColor.a, blendState.blendFactor.g)),
+                getValue(blendState.colorOperation,
+                         srcColor.b * getValue(blendState.colorBlendSource, srcColor.b, srcColor.a, destColor.b, destColor.a, blendState.blendFactor.b),
+                         destColor.b * getValue(blendState.colorBlendDest, srcColor.b, srcColor.a, destColor.b, destColor.a, blendState.blendFactor.b)),
+                getValue(blendState.alphaOperation,
+                         srcColor.a * getValue(blendState.alphaBlendSource, srcColor.a, srcColor.a, destColor.a, destColor.a, blendState.blendFactor.a),
+                         destColor.a * getValue(blendState.alphaBlendDest, srcColor.a, srcColor.a, destColor.a, destColor.a, blendState.blendFactor.a))
+            };
+
+            return resultColor.getIntValueRaw();
+        }
+
+        inline void rasterizeTriangle(const Triangle& triangle,
+                                      const DrawCall& drawCall,
+                                      const Surface<std::uint32_t>& colorSurface,
+                                      const Surface<float>& depthSurface,
+                                      PipelineStatistics* statistics)
+        {
+            const auto& vsOutputs = triangle.vsOutputs;
+            const auto& blendState = drawCall.blendState;
+            const auto& depthState = drawCall.depthState;
+            const auto& v0 = triangle.v0;
+            const auto& v1 = triangle.v1;
+            const auto den = triangle.den;
+            const auto sampleCount = colorSurface.sampleCount;
+            const auto samplePositions = getSamplePositions(sampleCount);
+
+            const auto minX = std::max(triangle.minX, colorSurface.x);
+            const auto minY = std::max(triangle.minY, colorSurface.y);
+            const auto maxX = std::min(triangle.maxX, colorSurface.x + colorSurface.width - 1);
+            const auto maxY = std::min(triangle.maxY, colorSurface.y + colorSurface.height - 1);
+
+            PipelineStatistics counters;
+            std::uint64_t samplesPassed = 0;
+
+            for (auto screenY = minY; screenY <= maxY; ++screenY)
+                for (auto screenX = minX; screenX <= maxX; ++screenX)
                 {
                     const Vector<float, 2> p{
                         static_cast<float>(screenX),
                         static_cast<float>(screenY)
                     };
 
-                    const auto v2 = p - viewportPositions[0];
+                    // build the coverage mask of the samples that are inside of the triangle and pass the depth test
+                    std::uint32_t coverage = 0;
+                    std::array<float, 8> sampleDepths;
+                    Vector<float, 3> clip;
+                    bool covered = false;
+
+                    if constexpr (pipelineStatisticsEnabled) ++counters.pixelsVisited;
+
+                    for (std::size_t sample = 0; sample < sampleCount; ++sample)
+                    {
+                        const auto v2 = p + samplePositions[sample] - triangle.origin;
+
+                        // calculate barycentric coordinates
+                        const auto v = (v2.v[0] * v1.v[1] - v1.v[0] * v2.v[1]) / den;
+                        const auto w = (v0.v[0] * v2.v[1] - v2.v[0] * v0.v[1]) / den;
+
+                        if (v >= 0.0F && w >= 0.0F && v + w <= 1.0F)
+                        {
+                            const auto u = 1.0F - v - w;
+
+                            clip = Vector<float, 3>{
+                                u / vsOutputs[0].position.v[3],
+                                v / vsOutputs[1].position.v[3],
+                                w / vsOutputs[2].position.v[3]
+                            };
+                            clip /= (clip.v[0] + clip.v[1] + clip.v[2]);
+
+                            const auto depth = triangle.depths[0] * clip.v[0] + triangle.depths[1] * clip.v[1] + triangle.depths[2] * clip.v[2];
+
+                            if constexpr (pipelineStatisticsEnabled) covered = true;
+
+                            if (depthState.read && depthSurface.at(screenX, screenY, sample) < depth)
+                            {
+                                if constexpr (pipelineStatisticsEnabled) ++counters.depthTestsFailed;
+                                continue; // discard the sample
+                            }
 
-                    // calculate barycentric coordinates
-                    const auto v = (v2.v[0] * v1.v[1] - v1.v[0] * v2.v[1]) / den;
-                    const auto w = (v0.v[0] * v2.v[1] - v2.v[0] * v0.v[1]) / den;
+                            if constexpr (pipelineStatisticsEnabled)
+                                if (depthState.read) ++counters.depthTestsPassed;
 
-                    if (v >= 0.0F && w >= 0.0F && v + w <= 1.0F)
+                            sampleDepths[sample] = depth;
+                            coverage |= 1U << sample;
+                            ++samplesPassed;
+                        }
+                    }
+
+                    if constexpr (pipelineStatisticsEnabled)
+                        if (covered) ++counters.pixelsCovered;
+
+                    if (!coverage)
+                        continue; // discard the pixel
+
+                    if (depthState.write)
+                        for (std::size_t sample = 0; sample < sampleCount; ++sample)
+                            if (coverage & (1U << sample))
+                                depthSurface.at(screenX, screenY, sample) = sampleDepths[sample];
+
+                    // the fragment shader runs once per pixel with the attributes at the pixel position
+                    if (sampleCount > 1)
                     {
+                        const auto v2 = p - triangle.origin;
+                        const auto v = (v2.v[0] * v1.v[1] - v1.v[0] * v2.v[1]) / den;
+                        const auto w = (v0.v[0] * v2.v[1] - v2.v[0] * v0.v[1]) / den;
                         const auto u = 1.0F - v - w;
 
-                        Vector<float, 3> clip{
+                        clip = Vector<float, 3>{
                             u / vsOutputs[0].position.v[3],
                             v / vsOutputs[1].position.v[3],
                             w / vsOutputs[2].position.v[3]
                         };
                         clip /= (clip.v[0] + clip.v[1] + clip.v[2]);
+                    }
+
+                    const auto psInput = interpolate(vsOutputs, clip, drawCall.fragmentShaderInputs, drawCall.customVaryingCount);
+                    const auto srcColor = drawCall.fragmentShader(psInput, drawCall.samplers, drawCall.textures, drawCall.constants);
+                    const auto srcValue = srcColor.getIntValueRaw();
+
+                    if constexpr (pipelineStatisticsEnabled)
+                    {
+                        ++counters.fragmentShaderInvocations;
+                        if (blendState.enabled) ++counters.pixelsBlended;
+                    }
+
+                    for (std::size_t sample = 0; sample < sampleCount; ++sample)
+                        if (coverage & (1U << sample))
+                        {
+                            auto& pixelValue = colorSurface.at(screenX, screenY, sample);
+                            pixelValue = blendState.enabled ? blend(blendState, srcColor, pixelValue) : srcValue;
+                        }
+                }
 
-                        const auto depth = ndcPositions[0].v[2] * clip.v[0] + ndcPositions[1].v[2] * clip.v[1] + ndcPositions[2].v[2] * clip.v[2];
+            if (drawCall.query && samplesPassed)
+                drawCall.query->addSamples(samplesPassed);
 
-                        if (depthState.read && depthBufferData[screenY * depthBuffer.getWidth() + screenX] < depth)
-                            continue; // discard the pixel
+            if constexpr (pipelineStatisticsEnabled)
+                if (statistics) *statistics += counters;
+        }
 
-                        if (depthState.write)
-                            depthBufferData[screenY * depthBuffer.getWidth() + screenX] = depth;
+        template <typename T>
+        void loadSurface(const Surface<T>& surface,
+                         const T* textureData,
+                         const std::size_t textureWidth)
+        {
+            const auto rowSize = surface.width * surface.sampleCount;
 
-                        VertexShaderOutput psInput;
-                        psInput.position = Vector<float, 4>{clip.v[0], clip.v[1], clip.v[2], 1.0F};
-                        psInput.color = Color{
-                            vsOutputs[0].color.r * clip.v[0] + vsOutputs[1].color.r * clip.v[1] + vsOutputs[2].color.r * clip.v[2],
-                            vsOutputs[0].color.g * clip.v[0] + vsOutputs[1].color.g * clip.v[1] + vsOutputs[2].color.g * clip.v[2],
-                            vsOutputs[0].color.b * clip.v[0] + vsOutputs[1].color.b * clip.v[1] + vsOutputs[2].color.b * clip.v[2],
-                            vsOutputs[0].color.a * clip.v[0] + vsOutputs[1].color.a * clip.v[1] + vsOutputs[2].color.a * clip.v[2]
-                        };
+            for (std::size_t y = 0; y < surface.height; ++y)
+            {
+                const auto source = textureData + ((surface.y + y) * textureWidth + surface.x) * surface.sampleCount;
+                std::copy(source, source + rowSize, surface.data + y * surface.pitch * surface.sampleCount);
+            }
+        }
 
-                        psInput.texCoords[0] = Vector<float, 2>{
-                            vsOutputs[0].texCoords[0].v[0] * clip.v[0] + vsOutputs[1].texCoords[0].v[0] * clip.v[1] + vsOutputs[2].texCoords[0].v[0] * clip.v[2],
-                            vsOutputs[0].texCoords[0].v[1] * clip.v[0] + vsOutputs[1].texCoords[0].v[1] * clip.v[1] + vsOutputs[2].texCoords[0].v[1] * clip.v[2]
-                        };
+        template <typename T>
+        void storeSurface(const Surface<T>& surface,
+                          T* textureData,
+                          const std::size_t textureWidth)
+        {
+            const auto rowSize = surface.width * surface.sampleCount;
 
-                        psInput.texCoords[1] = Vector<float, 2>{
-                            vsOutputs[0].texCoords[1].v[0] * clip.v[0] + vsOutputs[1].texCoords[1].v[0] * clip.v[1] + vsOutputs[2].texCoords[1].v[0] * clip.v[2],
-                            vsOutputs[0].texCoords[1].v[1] * clip.v[0] + vsOutputs[1].texCoords[1].v[1] * clip.v[1] + vsOutputs[2].texCoords[1].v[1] * clip.v[2]
-                        };
+            for (std::size_t y = 0; y < surface.height; ++y)
+            {
+                const auto source = surface.data + y * surface.pitch * surface.sampleCount;
+                std::copy(source, source + rowSize, textureData + ((surface.y + y) * textureWidth + surface.x) * surface.sampleCount);
+            }
+        }
 
-                        psInput.normal = vsOutputs[0].normal * clip.v[0] + vsOutputs[1].normal * clip.v[1] + vsOutputs[2].normal * clip.v[2];
+        template <typename T>
+        void fillSurface(const Surface<T>& surface, const T value)
+        {
+            const auto rowSize = surface.width * surface.sampleCount;
 
-                        const auto srcColor = fragmentShader(psInput, samplers, textures);
+            for (std::size_t y = 0; y < surface.height; ++y)
+            {
+                const auto row = surface.data + y * surface.pitch * surface.sampleCount;
+                std::fill(row, row + rowSize, value);
+            }
+        }
 
-                        if (blendState.enabled)
-                        {
-                            const auto pixel = reinterpret_cast<std::uint8_t*>(&frameBufferData[screenY * frameBuffer.getWidth() + screenX]);
-                            const Color destColor{pixel[0], pixel[1], pixel[2], pixel[3]};
-
-                            // alpha blend
-                            const Color resultColor{
-                                getValue(blendState.colorOperation,
-                                         srcColor.r * getValue(blendState.colorBlendSource, srcColor.r, srcColor.a, destColor.r, destColor.a, blendState.blendFactor.r),
-                                         destColor.r * getValue(blendState.colorBlendDest, srcColor.r, srcColor.a, destColor.r, destColor.a, blendState.blendFactor.r)),
-                                getValue(blendState.colorOperation,
-                                         srcColor.g * getValue(blendState.colorBlendSource, srcColor.g, srcColor.a, destColor.g, destColor.a, blendState.blendFactor.g),
-                                         destColor.g * getValue(blendState.colorBlendDest, srcColor.g, srcColor.a, destColor.g, destColor.a, blendState.blendFactor.g)),
-                                getValue(blendState.colorOperation,
-                                         srcColor.b * getValue(blendState.colorBlendSource, srcColor.b, srcColor.a, destColor.b, destColor.a, blendState.blendFactor.b),
-                                         destColor.b * getValue(blendState.colorBlendDest, srcColor.b, srcColor.a, destColor.b, destColor.a, blendState.blendFactor.b)),
-                                getValue(blendState.alphaOperation,
-                                         srcColor.a * getValue(blendState.alphaBlendSource, srcColor.a, srcColor.a, destColor.a, destColor.a, blendState.blendFactor.a),
-                                         destColor.a * getValue(blendState.alphaBlendDest, srcColor.a, srcColor.a, destColor.a, destColor.a, blendState.blendFactor.a))
-                            };
+        // rows [begin, end) of the surface
+        template <typename T>
+        [[nodiscard]] Surface<T> getRows(const Surface<T>& surface,
+                                         const std::size_t begin,
+                                         const std::size_t end) noexcept
+        {
+            return Surface<T>{
+                surface.data + begin * surface.pitch * surface.sampleCount,
+                surface.pitch,
+                surface.x,
+                surface.y + begin,
+                surface.width,
+                end - begin,
+                surface.sampleCount
+            };
+        }
 
-                            frameBufferData[screenY * frameBuffer.getWidth() + screenX] = resultColor.getIntValueRaw();
+        inline void resolveSurface(const Surface<std::uint32_t>& surface,
+                                   std::uint32_t* textureData,
+                                   const std::size_t textureWidth)
+        {
+            for (std::size_t y = 0; y < surface.height; ++y)
+                resolvePixels(surface.data + y * surface.pitch * surface.sampleCount,
+                              surface.sampleCount,
+                              textureData + (surface.y + y) * textureWidth + surface.x,
+                              surface.width);
+        }
+    }
+
+    // the geometry stages, the tiles and the clears are spread over the job system if one is given,
+    // statistics receives the counters of every draw call if SR_PIPELINE_STATISTICS is enabled
+    inline void drawTriangles(const RenderPass& renderPass,
+                              const std::vector<DrawCall>& drawCalls,
+                              JobSystem* jobSystem = nullptr,
+                              std::vector<PipelineStatistics>* statistics = nullptr)
+    {
+        const auto& colorAttachment = renderPass.colorAttachment;
+        const auto& depthAttachment = renderPass.depthAttachment;
+
+        const auto colorView = colorAttachment.texture ? TextureView{*colorAttachment.texture} : colorAttachment.view;
+        const auto depthView = depthAttachment.texture ? TextureView{*depthAttachment.texture} : depthAttachment.view;
+        const auto resolveView = colorAttachment.resolveTexture ? TextureView{*colorAttachment.resolveTexture} : colorAttachment.resolveView;
+
+        // the surfaces address the attachments in whole pixels
+        const auto isAligned = [](const TextureView& view) {
+            return view.getPitch() % (view.getSampleCount() * getPixelSize(view.getPixelFormat())) == 0;
+        };
+
+        const auto width = colorView.getWidth();
+        const auto height = colorView.getHeight();
+        const auto sampleCount = colorView.getSampleCount();
+
+        if ((!colorAttachment.texture && !colorView.getData()) ||
+            colorView.getPixelFormat() != PixelFormat::rgba8 ||
+            !isAligned(colorView))
+            throw RenderError{"Invalid color attachment"};
+
+        const auto hasDepth = depthAttachment.texture || depthView.getData();
+
+        if (hasDepth)
+        {
+            if (depthView.getPixelFormat() != PixelFormat::float32 ||
+                depthView.getWidth() != width ||
+                depthView.getHeight() != height ||
+                depthView.getSampleCount() != sampleCount ||
+                !isAligned(depthView))
+                throw RenderError{"Invalid depth attachment"};
+        }
+        else if (depthAttachment.loadAction == RenderPass::LoadAction::load ||
+                 depthAttachment.storeAction == RenderPass::StoreAction::store)
+            throw RenderError{"Depth attachment without a texture can not be loaded or stored"};
+
+        if ((colorAttachment.resolveTexture || resolveView.getData()) &&
+            (resolveView.getPixelFormat() != PixelFormat::rgba8 ||
+             resolveView.getWidth() != width ||
+             resolveView.getHeight() != height ||
+             resolveView.getSampleCount() != 1 ||
+             !isAligned(resolveView)))
+            throw RenderError{"Invalid resolve texture"};
+
+        for (const auto& drawCall : drawCalls)
+            detail::validateDrawCall(drawCall);
+
+        TraceScope passTrace{"drawTriangles"};
+
+        const auto writeTimestamp = [](Query* query) {
+            if (query) query->writeTimestamp();
+        };
+
+        // the samples passed queries become available when every tile is done
+        const auto finishPass = [&renderPass, &drawCalls, &writeTimestamp]() {
+            for (const auto& drawCall : drawCalls)
+                if (drawCall.query) drawCall.query->complete();
+            writeTimestamp(renderPass.endTimestamp);
+        };
+
+        writeTimestamp(renderPass.beginTimestamp);
+
+        if (statistics)
+            statistics->assign(drawCalls.size(), PipelineStatistics{});
+
+        if (width == 0 || height == 0)
+        {
+            writeTimestamp(renderPass.geometryTimestamp);
+            finishPass();
+            return;
+        }
+
+        const auto depthUsed = std::any_of(drawCalls.begin(), drawCalls.end(), [](const DrawCall& drawCall) {
+            return drawCall.depthState.read || drawCall.depthState.write;
+        });
+
+        const auto colorData = reinterpret_cast<std::uint32_t*>(colorView.getData());
+        const auto depthData = hasDepth ? reinterpret_cast<float*>(depthView.getData()) : nullptr;
+        const auto resolveData = reinterpret_cast<std::uint32_t*>(resolveView.getData());
+
+        // row pitches in pixels
+        const auto colorPitch = colorView.getPitch() / (sampleCount * sizeof(std::uint32_t));
+        const auto depthPitch = hasDepth ? depthView.getPitch() / (sampleCount * sizeof(float)) : width;
+        const auto resolvePitch = resolveView.getPitch() / sizeof(std::uint32_t);
+
+        std::vector<detail::Triangle> triangles;
+
+        if (renderPass.tileSize == 0)
+        {
+            const detail::Surface<std::uint32_t> colorSurface{colorData, colorPitch, 0, 0, width, height, sampleCount};
+
+            // without a depth texture the depth lives in a transient buffer for the duration of the pass
+            std::vector<float> transientDepth;
+            detail::Surface<float> depthSurface{depthData, depthPitch, 0, 0, width, height, sampleCount};
+
+            if (!hasDepth && depthUsed)
+            {
+                transientDepth.resize(width * height * sampleCount);
+                depthSurface.data = transientDepth.data();
+            }
+
+            const auto clearColor = colorAttachment.loadAction == RenderPass::LoadAction::clear;
+            const auto clearDepth = depthSurface.data && depthAttachment.loadAction != RenderPass::LoadAction::load;
+
+            if (clearColor || clearDepth)
+                detail::parallelFor(jobSystem, 0, height, 16, [&](const std::size_t begin, const std::size_t end) {
+                    TraceScope trace{"clear"};
+                    if (clearColor)
+                        detail::fillSurface(detail::getRows(colorSurface, begin, end), colorAttachment.clearColor.getIntValueRaw());
+                    if (clearDepth)
+                        detail::fillSurface(detail::getRows(depthSurface, begin, end), depthAttachment.clearDepth);
+                });
+
+            if (drawCalls.empty()) writeTimestamp(renderPass.geometryTimestamp);
+
+            for (std::size_t drawIndex = 0; drawIndex < drawCalls.size(); ++drawIndex)
+            {
+                triangles.clear();
+                const auto drawStatistics = statistics ? &(*statistics)[drawIndex] : nullptr;
+                detail::setupTriangles(drawCalls[drawIndex], drawIndex, width, height, sampleCount, triangles, jobSystem, drawStatistics);
+
+                if (drawIndex + 1 == drawCalls.size()) writeTimestamp(renderPass.geometryTimestamp);
+
+                TraceScope trace{"raster"};
+                for (const auto& triangle : triangles)
+                    detail::rasterizeTriangle(triangle, drawCalls[drawIndex], colorSurface, depthSurface, drawStatistics);
+            }
+
+            if (resolveData)
+            {
+                TraceScope trace{"resolve"};
+                detail::resolveSurface(colorSurface, resolveData, resolvePitch);
+            }
+
+            // store actions have nothing left to do, the pixels were written straight into the attachments
+        }
+        else
+        {
+            const auto tileSize = renderPass.tileSize;
+            const auto tilesX = (width + tileSize - 1) / tileSize;
+            const auto tilesY = (height + tileSize - 1) / tileSize;
+
+            for (std::size_t drawIndex = 0; drawIndex < drawCalls.size(); ++drawIndex)
+                detail::setupTriangles(drawCalls[drawIndex], drawIndex, width, height, sampleCount, triangles, jobSystem,
+                                       statistics ? &(*statistics)[drawIndex] : nullptr);
+
+            // bin the triangles by the tiles their bounding boxes touch, keeping the submission order
+            std::vector<std::vector<std::uint32_t>> bins(tilesX * tilesY);
+            {
+                TraceScope trace{"bin"};
+                for (std::size_t t = 0; t < triangles.size(); ++t)
+                    for (auto tileY = triangles[t].minY / tileSize; tileY <= triangles[t].maxY / tileSize; ++tileY)
+                        for (auto tileX = triangles[t].minX / tileSize; tileX <= triangles[t].maxX / tileSize; ++tileX)
+                            bins[tileY * tilesX + tileX].push_back(static_cast<std::uint32_t>(t));
+            }
+
+            writeTimestamp(renderPass.geometryTimestamp);
+
+            // the depth tile is needed only if the draws use it or if the texture has to be cleared
+            const auto depthTileUsed = depthUsed ||
+                (hasDepth &&
+                 depthAttachment.loadAction == RenderPass::LoadAction::clear &&
+                 depthAttachment.storeAction == RenderPass::StoreAction::store);
+
+            // the rasterization counters are gathered per scratch and added up after the tiles are done
+            const auto rasterStatisticsUsed = pipelineStatisticsEnabled && statistics;
+            detail::TileScratchPool scratchPool;
+
+            detail::parallelFor(jobSystem, 0, tilesX * tilesY, 1, [&](const std::size_t begin, const std::size_t end) {
+                auto& scratch = scratchPool.acquire();
+                auto& colorTile = scratch.colorTile;
+                auto& depthTile = scratch.depthTile;
+                colorTile.resize(tileSize * tileSize * sampleCount);
+                if (depthTileUsed) depthTile.resize(tileSize * tileSize * sampleCount);
+                if (rasterStatisticsUsed) scratch.statistics.resize(drawCalls.size());
+                const auto drawStatistics = rasterStatisticsUsed ? scratch.statistics.data() : nullptr;
+
+                for (auto tile = begin; tile < end; ++tile)
+                {
+                    const auto tileX = tile % tilesX;
+                    const auto tileY = tile / tilesX;
+                    const auto x = tileX * tileSize;
+                    const auto y = tileY * tileSize;
+                    const auto tileWidth = std::min(tileSize, width - x);
+                    const auto tileHeight = std::min(tileSize, height - y);
+
+                    const detail::Surface<std::uint32_t> colorSurface{colorTile.data(), tileSize, x, y, tileWidth, tileHeight, sampleCount};
+                    const detail::Surface<float> depthSurface{depthTile.data(), tileSize, x, y, tileWidth, tileHeight, sampleCount};
+
+                    TraceScope tileTrace{"tile"};
+
+                    {
+                        TraceScope trace{"load"};
+
+                        if (colorAttachment.loadAction == RenderPass::LoadAction::load)
+                            detail::loadSurface(colorSurface, colorData, colorPitch);
+                        else if (colorAttachment.loadAction == RenderPass::LoadAction::clear)
+                            detail::fillSurface(colorSurface, colorAttachment.clearColor.getIntValueRaw());
+
+                        if (depthTileUsed)
+                        {
+                            if (depthAttachment.loadAction == RenderPass::LoadAction::load)
+                                detail::loadSurface(depthSurface, static_cast<const float*>(depthData), depthPitch);
+                            else if (depthAttachment.loadAction == RenderPass::LoadAction::clear)
+                                detail::fillSurface(depthSurface, depthAttachment.clearDepth);
                         }
-                        else
-                            frameBufferData[screenY * frameBuffer.getWidth() + screenX] = srcColor.getIntValueRaw();
                     }
+
+                    {
+                        TraceScope trace{"raster"};
+
+                        for (const auto t : bins[tile])
+                            detail::rasterizeTriangle(triangles[t], drawCalls[triangles[t].drawIndex], colorSurface, depthSurface,
+                                                      drawStatistics ? &drawStatistics[triangles[t].drawIndex] : nullptr);
+                    }
+
+                    TraceScope trace{"store"};
+
+                    if (colorAttachment.storeAction == RenderPass::StoreAction::store)
+                        detail::storeSurface(colorSurface, colorData, colorPitch);
+
+                    // the samples are resolved straight from the tile buffer
+                    if (resolveData)
+                        detail::resolveSurface(colorSurface, resolveData, resolvePitch);
+
+                    // discarded depth never leaves the tile buffer
+                    if (depthTileUsed && depthAttachment.storeAction == RenderPass::StoreAction::store)
+                        detail::storeSurface(depthSurface, depthData, depthPitch);
                 }
+
+                scratchPool.release(scratch);
+            });
+
+            if (rasterStatisticsUsed)
+                for (const auto& scratch : scratchPool.getScratches())
+                    for (std::size_t drawIndex = 0; drawIndex < scratch->statistics.size(); ++drawIndex)
+                        (*statistics)[drawIndex] += scratch->statistics[drawIndex];
         }
+
+        finishPass();
+    }
+
+    inline void drawTriangles(Texture& frameBuffer,
+                              Texture& depthBuffer,
+                              VertexShader vertexShader,
+                              FragmentShader fragmentShader,
+                              const std::array<const Sampler*, 2>& samplers,
+                              const std::array<const Texture*, 2>& textures,
+                              const Rect<float>& viewport,
+                              const Rect<float>& scissorRect,
+                              const BlendState& blendState,
+                              const DepthState& depthState,
+                              const IndexBufferView& indices,
+                              const std::vector<Vertex>& vertices,
+                              const Matrix<float, 4>& modelViewProjection)
+    {
+        DrawCall drawCall;
+        drawCall.vertexShader = vertexShader;
+        drawCall.fragmentShader = fragmentShader;
+        drawCall.samplers = samplers;
+        drawCall.textures = {
+            textures[0] ? TextureView{*textures[0]} : TextureView{},
+            textures[1] ? TextureView{*textures[1]} : TextureView{}
+        };
+        drawCall.viewport = viewport;
+        drawCall.scissorRect = scissorRect;
+        drawCall.blendState = blendState;
+        drawCall.depthState = depthState;
+        drawCall.indices = indices;
+        drawCall.vertices = &vertices;
+        drawCall.modelViewProjection = modelViewProjection;
+
+        RenderPass renderPass;
+        renderPass.colorAttachment.texture = &frameBuffer;
+
+        if (depthState.read || depthState.write)
+            renderPass.depthAttachment.texture = &depthBuffer;
+        else
+        {
+            renderPass.depthAttachment.loadAction = RenderPass::LoadAction::dontCare;
+            renderPass.depthAttachment.storeAction = RenderPass::StoreAction::discard;
+        }
+
+        drawTriangles(renderPass, {drawCall});
     }
 }
 
@@ -6,26 +6,57 @@
 #define SR_SHADER_HPP
 
 #include <array>
+#include <cstddef>
+#include <cstdint>
+#include "ConstantBuffer.hpp"
+#include "Instance.hpp"
 #include "Matrix.hpp"
-#include "Texture.hpp"
+#include "TextureView.hpp"
 #include "Vertex.hpp"
 
 namespace sr
 {
+    // the outputs of the vertex shader that are interpolated for the fragment shader
+    enum class Varying
+    {
+        color,
+        texCoord0,
+        texCoord1,
+        normal
+    };
+
+    constexpr std::size_t varyingCount = 4;
+
+    [[nodiscard]] constexpr std::uint32_t getMask(const Varying varying) noexcept
+    {
+        return 1U << static_cast<std::uint32_t>(varying);
+    }
+
+    constexpr std::uint32_t allVaryings = (1U << varyingCount) - 1U;
+
+    // floats that the shaders can use for their own varyings, every triangle carries them for its three vertices
+    constexpr std::size_t maxCustomVaryings = 4;
+
     struct VertexShaderOutput final
     {
         Vector<float, 4> position;
         Color color;
         std::array<Vector<float, 2>, 2> texCoords;
         Vector<float, 3> normal;
+        std::array<float, maxCustomVaryings> varyings{};
     };
 
+    // modelViewProjection already includes the transform of the instance,
+    // both shaders of a draw get the same constants
     using VertexShader = VertexShaderOutput(const Matrix<float, 4>& modelViewProjection,
-                                            const Vertex& vertex);
+                                            const Vertex& vertex,
+                                            const Instance& instance,
+                                            const ConstantBuffer& constants);
 
     using FragmentShader = Color(const VertexShaderOutput& input,
                                  const std::array<const Sampler*, 2>& samplers,
-                                 const std::array<const Texture*, 2>& textures);
+                                 const std::array<TextureView, 2>& textures,
+                                 const ConstantBuffer& constants);
 }
 
 #endif
@@ -5,6 +5,7 @@
 #ifndef SR_TEXTURE_HPP
 #define SR_TEXTURE_HPP
 
+#include <array>
 #include <climits>
 #include <stdexcept>
 #include <vector>
@@ -13,6 +14,116 @@
 
 namespace sr
 {
+    namespace detail
+    {
+        // pitch is the distance between the rows in bytes
+        [[nodiscard]] inline Color getPixel(const std::uint8_t* data,
+                                            const PixelFormat pixelFormat,
+                                            const std::size_t pitch,
+                                            const std::size_t x,
+                                            const std::size_t y)
+        {
+            const auto row = data + y * pitch;
+
+            switch (pixelFormat)
+            {
+                case PixelFormat::r8:
+                {
+                    const auto* r = &row[x * 1];
+                    return Color{*r, *r, *r, std::uint8_t(255U)};
+                }
+                case PixelFormat::a8:
+                {
+                    const auto* a = &row[x * 1];
+                    return Color{std::uint8_t(0U), std::uint8_t(0U), std::uint8_t(0U), *a};
+                }
+                case PixelFormat::rgba8:
+                {
+                    const auto* rgba = &row[x * 4];
+                    return Color{rgba[0], rgba[1], rgba[2], rgba[3]};
+                }
+                case PixelFormat::float32:
+                {
+                    const float f = reinterpret_cast<const float*>(row)[x];
+                    return Color{f, f, f, 1.0F};
+                }
+                default:
+                    throw std::runtime_error{"Invalid pixel format"};
+            }
+        }
+
+        // fractional part of the coordinate, also for negative coordinates
+        [[nodiscard]] inline float repeat(const float coord) noexcept
+        {
+            const auto result = std::fmod(coord, 1.0F);
+            return (result < 0.0F) ? result + 1.0F : result;
+        }
+
+        // multisampled pixels are sampled by their first sample
+        [[nodiscard]] inline Color sample(const std::uint8_t* data,
+                                          const PixelFormat pixelFormat,
+                                          const std::size_t width,
+                                          const std::size_t height,
+                                          const std::size_t pitch,
+                                          const std::size_t sampleCount,
+                                          const Sampler& sampler,
+                                          const Vector<float, 2>& coord)
+        {
+            const auto u =
+                (sampler.addressModeX == Sampler::AddressMode::clamp) ? std::clamp(coord.v[0], 0.0F, 1.0F) * (width - 1) :
+                (sampler.addressModeX == Sampler::AddressMode::repeat) ? repeat(coord.v[0]) * (width - 1) :
+                (sampler.addressModeX == Sampler::AddressMode::mirror) ? (1.0F - 2.0F * std::fabs(repeat(coord.v[0] / 2.0F) - 0.5F)) * (width - 1) :
+                0.0F;
+
+            const auto v =
+                (sampler.addressModeY == Sampler::AddressMode::clamp) ? std::clamp(coord.v[1], 0.0F, 1.0F) * (height - 1) :
+                (sampler.addressModeY == Sampler::AddressMode::repeat) ? repeat(coord.v[1]) * (height - 1) :
+                (sampler.addressModeY == Sampler::AddressMode::mirror) ? (1.0F - 2.0F * std::fabs(repeat(coord.v[1] / 2.0F) - 0.5F)) * (height - 1) :
+                0.0F;
+
+            if (sampler.filter == Sampler::Filter::point)
+            {
+                const auto textureX = static_cast<std::size_t>(std::round(u));
+                const auto textureY = static_cast<std::size_t>(std::round(v));
+                return getPixel(data, pixelFormat, pitch, textureX * sampleCount, textureY);
+            }
+            else if (sampler.filter == Sampler::Filter::linear)
+            {
+                auto textureX0 = static_cast<std::size_t>(u - 0.5F);
+                auto textureX1 = textureX0 + 1;
+                auto textureY0 = static_cast<std::size_t>(v - 0.5F);
+                auto textureY1 = textureY0 + 1;
+
+                textureX0 = std::clamp(textureX0, static_cast<std::size_t>(0U), width - 1);
+                textureX1 = std::clamp(textureX1, static_cast<std::size_t>(0U), width - 1);
+                textureY0 = std::clamp(textureY0, static_cast<std::size_t>(0U), height - 1);
+                textureY1 = std::clamp(textureY1, static_cast<std::size_t>(0U), height - 1);
+
+                // TODO: calculate mip level
+                const Color color[4] = {
+                    getPixel(data, pixelFormat, pitch, textureX0 * sampleCount, textureY0),
+                    getPixel(data, pixelFormat, pitch, textureX1 * sampleCount, textureY0),
+                    getPixel(data, pixelFormat, pitch, textureX0 * sampleCount, textureY1),
+                    getPixel(data, pixelFormat, pitch, textureX1 * sampleCount, textureY1)
+                };
+
+                const auto x0 = u - (textureX0 + 0.5F);
+                const auto y0 = v - (textureY0 + 0.5F);
+                const auto x1 = (textureX0 + 1.5F) - u;
+                const auto y1 = (textureY0 + 1.5F) - v;
+                
+                return Color{
+                    color[0].r * x1 * y1 + color[1].r * x0 * y1 + color[2].r * x1 * y0 + color[3].r * x0 * y0,
+                    color[0].g * x1 * y1 + color[1].g * x0 * y1 + color[2].g * x1 * y0 + color[3].g * x0 * y0,
+                    color[0].b * x1 * y1 + color[1].b * x0 * y1 + color[2].b * x1 * y0 + color[3].b * x0 * y0,
+                    color[0].a * x1 * y1 + color[1].a * x0 * y1 + color[2].a * x1 * y0 + color[3].a * x0 * y0
+                };
+            }
+
+            return Color{};
+        }
+    }
+
     class Texture final
     {
     public:
@@ -20,19 +131,25 @@ namespace sr
         Texture(const PixelFormat initPixelFormat = PixelFormat::rgba8,
                 const std::size_t initWidth = 0,
                 const std::size_t initHeight = 0,
-                const bool initMipMaps = false):
+                const bool initMipMaps = false,
+                const std::size_t initSampleCount = 1):
             pixelFormat{initPixelFormat},
             width{initWidth},
             height{initHeight},
-            mipMaps{initMipMaps}
+            mipMaps{initMipMaps},
+            sampleCount{initSampleCount}
         {
+            if (sampleCount != 1 && sampleCount != 2 && sampleCount != 4 && sampleCount != 8)
+                throw std::runtime_error{"Invalid sample count"};
+
             const auto pixelSize = getPixelSize(pixelFormat);
 
             if (pixelSize > 0 && width > 0 && height > 0)
             {
-                levels.push_back(std::vector<std::uint8_t>(width * height * pixelSize));
+                levels.push_back(std::vector<std::uint8_t>(width * height * sampleCount * pixelSize));
 
-                if (mipMaps || true)
+                // multisampled textures have no mip levels
+                if ((mipMaps || true) && sampleCount == 1)
                 {
                     auto mipmapWidth = width >> 1;
                     auto mipmapHeight = height >> 1;
@@ -61,9 +178,9 @@ namespace sr
                 throw std::runtime_error{"Invalid pixel format"};
 
             levels.clear();
-            levels.push_back(std::vector<std::uint8_t>(width * height * pixelSize));
+            levels.push_back(std::vector<std::uint8_t>(width * height * sampleCount * pixelSize));
 
-            if (mipMaps)
+            if (mipMaps && sampleCount == 1)
             {
                 auto mipmapWidth = width >> 1;
                 auto mipmapHeight = height >> 1;
@@ -84,6 +201,7 @@ namespace sr
         [[nodiscard]] auto getPixelFormat() const noexcept { return pixelFormat; }
         [[nodiscard]] auto getWidth() const noexcept { return width; }
         [[nodiscard]] auto getHeight() const noexcept { return height; }
+        [[nodiscard]] auto getSampleCount() const noexcept { return sampleCount; }
 
         [[nodiscard]] std::size_t getLevelCount() const noexcept
         {
@@ -107,7 +225,7 @@ namespace sr
             if (pixelSize == 0)
                 throw std::runtime_error{"Invalid pixel format"};
 
-            if (buffer.size() != width * height * pixelSize)
+            if (buffer.size() != width * height * sampleCount * pixelSize)
                 throw std::runtime_error{"Invalid buffer size"};
 
             if (level >= levels.size()) levels.resize(level + 1);
@@ -118,90 +236,13 @@ namespace sr
                                      const std::size_t y,
                                      const std::uint32_t level) const
         {
-            const auto& buffer = levels[level];
-
-            switch (pixelFormat)
-            {
-                case PixelFormat::r8:
-                {
-                    const auto* r = &buffer[(y * width + x) * 1];
-                    return Color{*r, *r, *r, std::uint8_t(255U)};
-                }
-                case PixelFormat::a8:
-                {
-                    const auto* a = &buffer[(y * width + x) * 1];
-                    return Color{std::uint8_t(0U), std::uint8_t(0U), std::uint8_t(0U), *a};
-                }
-                case PixelFormat::rgba8:
-                {
-                    const auto* rgba = &buffer[(y * width + x) * 4];
-                    return Color{rgba[0], rgba[1], rgba[2], rgba[3]};
-                }
-                case PixelFormat::float32:
-                {
-                    const float f = reinterpret_cast<const float*>(buffer.data())[y * width + x];
-                    return Color{f, f, f, 1.0F};
-                }
-                default:
-                    throw std::runtime_error{"Invalid pixel format"};
-            }
+            return detail::getPixel(levels[level].data(), pixelFormat, width * sampleCount * getPixelSize(pixelFormat), x * sampleCount, y);
         }
 
         [[nodiscard]] Color sample(const Sampler* sampler, const Vector<float, 2>& coord) const
         {
             if (sampler && !levels.empty())
-            {
-                const auto u =
-                    (sampler->addressModeX == Sampler::AddressMode::clamp) ? std::clamp(coord.v[0], 0.0F, 1.0F) * (width - 1) :
-                    (sampler->addressModeX == Sampler::AddressMode::repeat) ? std::fmod(coord.v[0], 1.0F) * (width - 1) :
-                    (sampler->addressModeX == Sampler::AddressMode::mirror) ? 1.0F - 2.0F * std::fabs(std::fmod(coord.v[0] / 2.0F, 1.0F) - 0.5F) * (width - 1) :
-                    0.0F;
-
-                const auto v =
-                    (sampler->addressModeY == Sampler::AddressMode::clamp) ? std::clamp(coord.v[1], 0.0F, 1.0F) * (height - 1) :
-                    (sampler->addressModeY == Sampler::AddressMode::repeat) ? std::fmod(coord.v[1], 1.0F) * (height - 1) :
-                    (sampler->addressModeY == Sampler::AddressMode::mirror) ? 1.0F - 2.0F * std::fabs(std::fmod(coord.v[1] / 2.0F, 1.0F) - 0.5F) * (height - 1) :
-                    0.0F;
-
-                if (sampler->filter == Sampler::Filter::point)
-                {
-                    const auto textureX = static_cast<std::size_t>(std::round(u));
-                    const auto textureY = static_cast<std::size_t>(std::round(v));
-                    return getPixel(textureX, textureY, 0);
-                }
-                else if (sampler->filter == Sampler::Filter::linear)
-                {
-                    auto textureX0 = static_cast<std::size_t>(u - 0.5F);
-                    auto textureX1 = textureX0 + 1;
-                    auto textureY0 = static_cast<std::size_t>(v - 0.5F);
-                    auto textureY1 = textureY0 + 1;
-
-                    textureX0 = std::clamp(textureX0, static_cast<std::size_t>(0U), width - 1);
-                    textureX1 = std::clamp(textureX1, static_cast<std::size_t>(0U), width - 1);
-                    textureY0 = std::clamp(textureY0, static_cast<std::size_t>(0U), height - 1);
-                    textureY1 = std::clamp(textureY1, static_cast<std::size_t>(0U), height - 1);
-
-                    // TODO: calculate mip level
-                    const Color color[4] = {
-                        getPixel(textureX0, textureY0, 0),
-                        getPixel(textureX1, textureY0, 0),
-                        getPixel(textureX0, textureY1, 0),
-                        getPixel(textureX1, textureY1, 0)
-                    };
-
-                    const auto x0 = u - (textureX0 + 0.5F);
-                    const auto y0 = v - (textureY0 + 0.5F);
-                    const auto x1 = (textureX0 + 1.5F) - u;
-                    const auto y1 = (textureY0 + 1.5F) - v;
-                    
-                    return Color{
-                        color[0].r * x1 * y1 + color[1].r * x0 * y1 + color[2].r * x1 * y0 + color[3].r * x0 * y0,
-                        color[0].g * x1 * y1 + color[1].g * x0 * y1 + color[2].g * x1 * y0 + color[3].g * x0 * y0,
-                        color[0].b * x1 * y1 + color[1].b * x0 * y1 + color[2].b * x1 * y0 + color[3].b * x0 * y0,
-                        color[0].a * x1 * y1 + color[1].a * x0 * y1 + color[2].a * x1 * y0 + color[3].a * x0 * y0
-                    };
-                }
-            }
+                return detail::sample(levels[0].data(), pixelFormat, width, height, width * sampleCount * getPixelSize(pixelFormat), sampleCount, *sampler, coord);
 
             return Color{};
         }
@@ -211,6 +252,7 @@ namespace sr
         std::size_t width = 0;
         std::size_t height = 0;
         bool mipMaps = false;
+        std::size_t sampleCount = 1; // samples of a pixel are stored next to each other
         std::vector<std::vector<std::uint8_t>> levels;
         std::uint32_t minLOD = 0;
         std::uint32_t maxLOD = UINT_MAX;
@@ -224,7 +266,7 @@ namespace sr
         const auto bufferData = reinterpret_cast<std::uint32_t*>(renderTarget.getData().data());
         const auto rgba = color.getIntValueRaw();
 
-        const auto bufferSize = renderTarget.getWidth() * renderTarget.getHeight();
+        const auto bufferSize = renderTarget.getWidth() * renderTarget.getHeight() * renderTarget.getSampleCount();
         for (std::size_t p = 0; p < bufferSize; ++p)
             bufferData[p] = rgba;
     }
@@ -235,10 +277,54 @@ namespace sr
 
         const auto bufferData = reinterpret_cast<float*>(renderTarget.getData().data());
 
-        const auto bufferSize = renderTarget.getWidth() * renderTarget.getHeight();
+        const auto bufferSize = renderTarget.getWidth() * renderTarget.getHeight() * renderTarget.getSampleCount();
         for (std::size_t p = 0; p < bufferSize; ++p)
             bufferData[p] = depth;
     }
+
+    // averages the samples of every pixel
+    inline void resolvePixels(const std::uint32_t* samples,
+                              const std::size_t sampleCount,
+                              std::uint32_t* pixels,
+                              const std::size_t pixelCount) noexcept
+    {
+        for (std::size_t p = 0; p < pixelCount; ++p)
+        {
+            std::array<std::uint32_t, 4> sum{};
+
+            for (std::size_t s = 0; s < sampleCount; ++s)
+            {
+                const auto sample = reinterpret_cast<const std::uint8_t*>(&samples[p * sampleCount + s]);
+                sum[0] += sample[0];
+                sum[1] += sample[1];
+                sum[2] += sample[2];
+                sum[3] += sample[3];
+            }
+
+            const auto pixel = reinterpret_cast<std::uint8_t*>(&pixels[p]);
+            pixel[0] = static_cast<std::uint8_t>(sum[0] / sampleCount);
+            pixel[1] = static_cast<std::uint8_t>(sum[1] / sampleCount);
+            pixel[2] = static_cast<std::uint8_t>(sum[2] / sampleCount);
+            pixel[3] = static_cast<std::uint8_t>(sum[3] / sampleCount);
+        }
+    }
+
+    inline void resolve(const Texture& source, Texture& destination)
+    {
+        if (source.getPixelFormat() != PixelFormat::rgba8 ||
+            destination.getPixelFormat() != PixelFormat::rgba8)
+            throw std::runtime_error{"Invalid pixel format"};
+
+        if (destination.getSampleCount() != 1 ||
+            source.getWidth() != destination.getWidth() ||
+            source.getHeight() != destination.getHeight())
+            throw std::runtime_error{"Invalid resolve destination"};
+
+        resolvePixels(reinterpret_cast<const std::uint32_t*>(source.getData().data()),
+                      source.getSampleCount(),
+                      reinterpret_cast<std::uint32_t*>(destination.getData().data()),
+                      source.getWidth() * source.getHeight());
+    }
 }
 
 #endif
@@ -0,0 +1,134 @@
+//
+//  SoftwareRenderer
+//
+
+#ifndef SR_TEXTUREVIEW_HPP
+#define SR_TEXTUREVIEW_HPP
+
+#include <cassert>
+#include <cstdint>
+#include <stdexcept>
+#include "PixelFormat.hpp"
+#include "Sampler.hpp"
+#include "Texture.hpp"
+
+namespace sr
+{
+    // pixels of a texture or of memory owned by someone else (a shared memory segment, a mapped file),
+    // the memory must outlive the view
+    class TextureView final
+    {
+    public:
+        TextureView() = default;
+
+        // pitch is the distance between the rows in bytes, 0 means that the rows are tightly packed
+        TextureView(const PixelFormat initPixelFormat,
+                    void* initData,
+                    const std::size_t initWidth,
+                    const std::size_t initHeight,
+                    const std::size_t initPitch = 0,
+                    const std::size_t initSampleCount = 1):
+            pixelFormat{initPixelFormat},
+            data{static_cast<std::uint8_t*>(initData)},
+            width{initWidth},
+            height{initHeight},
+            pitch{initPitch ? initPitch : initWidth * initSampleCount * getPixelSize(initPixelFormat)},
+            sampleCount{initSampleCount}
+        {
+            if (getPixelSize(pixelFormat) == 0)
+                throw std::runtime_error{"Invalid pixel format"};
+
+            if (sampleCount != 1 && sampleCount != 2 && sampleCount != 4 && sampleCount != 8)
+                throw std::runtime_error{"Invalid sample count"};
+
+            if (pitch < width * sampleCount * getPixelSize(pixelFormat))
+                throw std::runtime_error{"Invalid pitch"};
+        }
+
+        // the first level of the texture, the view is invalidated by resizing the texture,
+        // the view of a const texture must only be sampled
+        explicit TextureView(const Texture& texture):
+            pixelFormat{texture.getPixelFormat()},
+            data{texture.getLevelCount() ? const_cast<std::uint8_t*>(texture.getData().data()) : nullptr},
+            width{texture.getWidth()},
+            height{texture.getHeight()},
+            pitch{texture.getWidth() * texture.getSampleCount() * getPixelSize(texture.getPixelFormat())},
+            sampleCount{texture.getSampleCount()}
+        {
+        }
+
+        [[nodiscard]] TextureView getSubView(const std::size_t x,
+                                             const std::size_t y,
+                                             const std::size_t subWidth,
+                                             const std::size_t subHeight) const
+        {
+            if (x + subWidth > width || y + subHeight > height)
+                throw std::runtime_error{"Invalid rectangle"};
+
+            TextureView result = *this;
+            result.data = data + y * pitch + x * sampleCount * getPixelSize(pixelFormat);
+            result.width = subWidth;
+            result.height = subHeight;
+            return result;
+        }
+
+        [[nodiscard]] auto getPixelFormat() const noexcept { return pixelFormat; }
+        [[nodiscard]] auto getData() const noexcept { return data; }
+        [[nodiscard]] auto getWidth() const noexcept { return width; }
+        [[nodiscard]] auto getHeight() const noexcept { return height; }
+        [[nodiscard]] auto getPitch() const noexcept { return pitch; }
+        [[nodiscard]] auto getSampleCount() const noexcept { return sampleCount; }
+
+        [[nodiscard]] Color getPixel(const std::size_t x, const std::size_t y) const
+        {
+            return detail::getPixel(data, pixelFormat, pitch, x * sampleCount, y);
+        }
+
+        [[nodiscard]] Color sample(const Sampler* sampler, const Vector<float, 2>& coord) const
+        {
+            if (sampler && data && width > 0 && height > 0)
+                return detail::sample(data, pixelFormat, width, height, pitch, sampleCount, *sampler, coord);
+
+            return Color{};
+        }
+
+    private:
+        PixelFormat pixelFormat = PixelFormat::rgba8;
+        std::uint8_t* data = nullptr;
+        std::size_t width = 0;
+        std::size_t height = 0;
+        std::size_t pitch = 0;
+        std::size_t sampleCount = 1; // samples of a pixel are stored next to each other
+    };
+
+    inline void clear(const TextureView& renderTarget, const Color color)
+    {
+        assert(renderTarget.getPixelFormat() == PixelFormat::rgba8);
+
+        const auto rgba = color.getIntValueRaw();
+        const auto rowSize = renderTarget.getWidth() * renderTarget.getSampleCount();
+
+        for (std::size_t y = 0; y < renderTarget.getHeight(); ++y)
+        {
+            const auto row = reinterpret_cast<std::uint32_t*>(renderTarget.getData() + y * renderTarget.getPitch());
+            for (std::size_t p = 0; p < rowSize; ++p)
+                row[p] = rgba;
+        }
+    }
+
+    inline void clear(const TextureView& renderTarget, const float depth)
+    {
+        assert(renderTarget.getPixelFormat() == PixelFormat::float32);
+
+        const auto rowSize = renderTarget.getWidth() * renderTarget.getSampleCount();
+
+        for (std::size_t y = 0; y < renderTarget.getHeight(); ++y)
+        {
+            const auto row = reinterpret_cast<float*>(renderTarget.getData() + y * renderTarget.getPitch());
+            for (std::size_t p = 0; p < rowSize; ++p)
+                row[p] = depth;
+        }
+    }
+}
+
+#endif
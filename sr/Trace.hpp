@@ -0,0 +1,298 @@
+//
+//  SoftwareRenderer
+//
+
+#ifndef SR_TRACE_HPP
+#define SR_TRACE_HPP
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <utility>
+#include <vector>
+#include "PerformanceCounters.hpp"
+
+namespace sr
+{
+    // records the timed scopes of all the threads into a ring buffer per thread
+    // and exports them in the Chrome trace event format (chrome://tracing, Perfetto),
+    // optionally with the hardware counter deltas of every scope
+    class Tracer final
+    {
+    public:
+        class Event final
+        {
+        public:
+            const char* name = nullptr;
+            std::uint64_t begin = 0; // nanoseconds since the creation of the tracer
+            std::uint64_t end = 0;
+            PerformanceCounters::Values counters; // counted by the thread during the scope
+        };
+
+        // capacity is the number of events kept per thread, the oldest ones are overwritten,
+        // counting reads the performance counters of the thread at the start and the end of every scope
+        explicit Tracer(const std::size_t initCapacity = 65536,
+                        const bool initCounting = false):
+            capacity{initCapacity ? initCapacity : 1},
+            counting{initCounting}
+        {
+        }
+
+        // like stop, it does not wait for the scopes that other threads have already started,
+        // so the tracer must be destroyed only after the traced work has finished
+        ~Tracer()
+        {
+            stop();
+        }
+
+        Tracer(const Tracer&) = delete;
+        Tracer& operator=(const Tracer&) = delete;
+        Tracer(Tracer&&) = delete;
+        Tracer& operator=(Tracer&&) = delete;
+
+        // the scopes of all the threads are recorded into this tracer until it is stopped
+        void start() noexcept
+        {
+            current().store(this, std::memory_order_release);
+        }
+
+        // the scopes that started before keep recording into this tracer until they end,
+        // e.g. the jobs that are still running on the workers of a job system
+        void stop() noexcept
+        {
+            auto expected = this;
+            current().compare_exchange_strong(expected, nullptr, std::memory_order_acq_rel);
+        }
+
+        [[nodiscard]] static Tracer* getCurrent() noexcept
+        {
+            return current().load(std::memory_order_acquire);
+        }
+
+        // names the calling thread in the traces it records into from now on
+        static void setThreadName(std::string name)
+        {
+            currentThreadName() = std::move(name);
+        }
+
+        [[nodiscard]] bool isCounting() const noexcept { return counting; }
+
+        // the counters of the calling thread, invalid if the tracer is not counting
+        [[nodiscard]] PerformanceCounters::Values readCounters()
+        {
+            return readCounters(getRing());
+        }
+
+        [[nodiscard]] std::uint64_t now() const noexcept
+        {
+            return static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - startTime).count());
+        }
+
+        // only the calling thread writes into its ring, so recording takes no locks after the first event of the thread,
+        // the name must outlive the tracer (a string literal)
+        void record(const char* name,
+                    const std::uint64_t begin,
+                    const std::uint64_t end,
+                    const PerformanceCounters::Values& counters = {})
+        {
+            record(getRing(), name, begin, end, counters);
+        }
+
+        // must be called while the traced threads are not recording, e.g. after the tracer has been stopped
+        // and the rendering has finished
+        void write(std::ostream& stream) const
+        {
+            std::unique_lock lock{ringMutex};
+
+            stream << "{\"traceEvents\":[";
+
+            bool first = true;
+            for (std::size_t r = 0; r < rings.size(); ++r)
+            {
+                const auto& ring = *rings[r];
+                const auto threadId = r + 1;
+
+                stream << (first ? "\n" : ",\n");
+                first = false;
+
+                stream << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << threadId << ",\"args\":{\"name\":\"";
+                writeEscaped(stream, ring.name.empty() ? "thread " + std::to_string(threadId) : ring.name);
+                stream << "\"}}";
+
+                const auto head = ring.head.load(std::memory_order_acquire);
+                const auto begin = (head > capacity) ? head - capacity : 0;
+
+                for (auto i = begin; i < head; ++i)
+                {
+                    const auto& event = ring.events[i % capacity];
+
+                    stream << ",\n{\"name\":\"";
+                    writeEscaped(stream, event.name);
+                    stream << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << threadId << ",\"ts\":";
+                    writeMicroseconds(stream, event.begin);
+                    stream << ",\"dur\":";
+                    writeMicroseconds(stream, event.end - event.begin);
+
+                    if (event.counters.isAnyValid())
+                    {
+                        stream << ",\"args\":{";
+                        bool firstCounter = true;
+                        for (std::size_t c = 0; c < PerformanceCounters::eventCount; ++c)
+                        {
+                            const auto counter = static_cast<PerformanceCounters::Event>(c);
+                            if (!event.counters.isValid(counter)) continue;
+
+                            stream << (firstCounter ? "\"" : ",\"") << PerformanceCounters::getName(counter) << "\":" << event.counters[counter];
+                            firstCounter = false;
+                        }
+                        stream << '}';
+                    }
+
+                    stream << '}';
+                }
+            }
+
+            stream << "\n],\"displayTimeUnit\":\"ms\"}\n";
+        }
+
+    private:
+        friend class TraceScope;
+
+        using Clock = std::chrono::steady_clock;
+
+        class Ring final
+        {
+        public:
+            Ring(const std::size_t capacity, std::string initName, const bool counting):
+                events(capacity),
+                name{std::move(initName)},
+                counters{counting ? std::make_unique<PerformanceCounters>() : nullptr}
+            {
+            }
+
+            std::vector<Event> events;
+            std::atomic<std::size_t> head{0}; // number of events ever recorded
+            std::string name;
+            std::unique_ptr<PerformanceCounters> counters; // opened by the thread of the ring
+        };
+
+        static std::atomic<Tracer*>& current() noexcept
+        {
+            static std::atomic<Tracer*> tracer{nullptr};
+            return tracer;
+        }
+
+        static std::string& currentThreadName() noexcept
+        {
+            thread_local std::string name;
+            return name;
+        }
+
+        static std::uint64_t nextId() noexcept
+        {
+            static std::atomic<std::uint64_t> lastId{0};
+            return ++lastId;
+        }
+
+        [[nodiscard]] static PerformanceCounters::Values readCounters(const Ring& ring) noexcept
+        {
+            return ring.counters ? ring.counters->read() : PerformanceCounters::Values{};
+        }
+
+        void record(Ring& ring,
+                    const char* name,
+                    const std::uint64_t begin,
+                    const std::uint64_t end,
+                    const PerformanceCounters::Values& counters) noexcept
+        {
+            const auto head = ring.head.load(std::memory_order_relaxed);
+            ring.events[head % capacity] = Event{name, begin, end, counters};
+            ring.head.store(head + 1, std::memory_order_release);
+        }
+
+        // the ring of the calling thread is created the first time the thread records into this tracer
+        Ring& getRing()
+        {
+            thread_local std::uint64_t ringTracerId = 0;
+            thread_local Ring* ring = nullptr;
+
+            if (ringTracerId != id)
+            {
+                std::unique_lock lock{ringMutex};
+                rings.push_back(std::make_unique<Ring>(capacity, currentThreadName(), counting));
+                ring = rings.back().get();
+                ringTracerId = id;
+            }
+
+            return *ring;
+        }
+
+        static void writeEscaped(std::ostream& stream, const std::string& text)
+        {
+            for (const auto c : text)
+            {
+                if (c == '"' || c == '\\') stream << '\\';
+                stream << c;
+            }
+        }
+
+        static void writeMicroseconds(std::ostream& stream, const std::uint64_t nanoseconds)
+        {
+            const auto fraction = nanoseconds % 1000;
+            stream << nanoseconds / 1000 << '.' <<
+                static_cast<char>('0' + fraction / 100) <<
+                static_cast<char>('0' + fraction / 10 % 10) <<
+                static_cast<char>('0' + fraction % 10);
+        }
+
+        std::size_t capacity;
+        bool counting = false;
+        std::uint64_t id = nextId(); // tells apart the tracers that were created at the same address
+        Clock::time_point startTime = Clock::now();
+        mutable std::mutex ringMutex;
+        std::vector<std::unique_ptr<Ring>> rings;
+    };
+
+    // records the time between its construction and destruction if a tracer is running,
+    // the ring of the thread is created by the constructor, so that the destructor does not allocate
+    class TraceScope final
+    {
+    public:
+        explicit TraceScope(const char* initName):
+            name{initName},
+            tracer{Tracer::getCurrent()}
+        {
+            if (!tracer) return;
+
+            ring = &tracer->getRing();
+            if (tracer->isCounting()) beginCounters = Tracer::readCounters(*ring);
+            begin = tracer->now();
+        }
+
+        ~TraceScope()
+        {
+            if (!tracer) return;
+
+            const auto end = tracer->now();
+            tracer->record(*ring, name, begin, end,
+                           tracer->isCounting() ? Tracer::readCounters(*ring) - beginCounters : PerformanceCounters::Values{});
+        }
+
+        TraceScope(const TraceScope&) = delete;
+        TraceScope& operator=(const TraceScope&) = delete;
+
+    private:
+        const char* name;
+        Tracer* tracer;
+        Tracer::Ring* ring = nullptr;
+        std::uint64_t begin = 0;
+        PerformanceCounters::Values beginCounters;
+    };
+}
+
+#endif
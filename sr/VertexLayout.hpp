@@ -0,0 +1,164 @@
+//
+//  SoftwareRenderer
+//
+
+#ifndef SR_VERTEXLAYOUT_HPP
+#define SR_VERTEXLAYOUT_HPP
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+#include "Vector.hpp"
+
+namespace sr
+{
+    enum class VertexAttribute
+    {
+        position,
+        color,
+        texCoord0,
+        texCoord1,
+        normal
+    };
+
+    constexpr std::size_t vertexAttributeCount = 5;
+
+    [[nodiscard]] constexpr std::uint32_t getMask(const VertexAttribute attribute) noexcept
+    {
+        return 1U << static_cast<std::uint32_t>(attribute);
+    }
+
+    constexpr std::uint32_t allVertexAttributes = (1U << vertexAttributeCount) - 1U;
+
+    enum class VertexFormat
+    {
+        float1,
+        float2,
+        float3,
+        float4,
+        half2, // IEEE 754 half precision floats
+        half4,
+        unorm8x4, // 0 to 255 mapped to 0 to 1, e.g. colors
+        snorm8x4 // -127 to 127 mapped to -1 to 1, e.g. packed normals
+    };
+
+    [[nodiscard]] constexpr std::size_t getVertexFormatSize(const VertexFormat format) noexcept
+    {
+        switch (format)
+        {
+            case VertexFormat::float1: return sizeof(float) * 1;
+            case VertexFormat::float2: return sizeof(float) * 2;
+            case VertexFormat::float3: return sizeof(float) * 3;
+            case VertexFormat::float4: return sizeof(float) * 4;
+            case VertexFormat::half2: return sizeof(std::uint16_t) * 2;
+            case VertexFormat::half4: return sizeof(std::uint16_t) * 4;
+            case VertexFormat::unorm8x4: return sizeof(std::uint8_t) * 4;
+            case VertexFormat::snorm8x4: return sizeof(std::int8_t) * 4;
+            default: return 0;
+        }
+    }
+
+    // where an attribute of every vertex is found, offset is in bytes from the start of the vertex in its stream
+    class VertexElement final
+    {
+    public:
+        VertexAttribute attribute = VertexAttribute::position;
+        VertexFormat format = VertexFormat::float4;
+        std::size_t stream = 0;
+        std::size_t offset = 0;
+    };
+
+    class VertexLayout final
+    {
+    public:
+        std::vector<VertexElement> elements;
+    };
+
+    constexpr std::size_t maxVertexStreams = 4;
+
+    // vertex data owned by someone else, stride is the distance between the vertices in bytes,
+    // size is the number of bytes that can be read from data
+    class VertexStream final
+    {
+    public:
+        const void* data = nullptr;
+        std::size_t stride = 0;
+        std::size_t size = 0;
+    };
+
+    namespace detail
+    {
+        [[nodiscard]] inline float halfToFloat(const std::uint16_t half) noexcept
+        {
+            const std::uint32_t sign = static_cast<std::uint32_t>(half & 0x8000U) << 16;
+            std::uint32_t exponent = (half >> 10) & 0x1FU;
+            std::uint32_t mantissa = half & 0x3FFU;
+
+            std::uint32_t bits;
+            if (exponent == 0x1FU) // infinity or NaN
+                bits = sign | 0x7F800000U | (mantissa << 13);
+            else if (exponent != 0)
+                bits = sign | ((exponent + 112) << 23) | (mantissa << 13);
+            else if (mantissa == 0)
+                bits = sign;
+            else
+            {
+                // subnormal half, normal float
+                exponent = 113;
+                while ((mantissa & 0x400U) == 0)
+                {
+                    mantissa <<= 1;
+                    --exponent;
+                }
+                bits = sign | (exponent << 23) | ((mantissa & 0x3FFU) << 13);
+            }
+
+            float result;
+            std::memcpy(&result, &bits, sizeof(result));
+            return result;
+        }
+
+        // the components that the format does not have are 0, except for w that is 1
+        [[nodiscard]] inline Vector<float, 4> readVertexElement(const VertexFormat format, const std::uint8_t* data) noexcept
+        {
+            Vector<float, 4> result{0.0F, 0.0F, 0.0F, 1.0F};
+
+            switch (format)
+            {
+                case VertexFormat::float1:
+                case VertexFormat::float2:
+                case VertexFormat::float3:
+                case VertexFormat::float4:
+                    std::memcpy(result.v.data(), data, getVertexFormatSize(format));
+                    break;
+                case VertexFormat::half2:
+                case VertexFormat::half4:
+                {
+                    std::uint16_t halves[4];
+                    const auto count = getVertexFormatSize(format) / sizeof(std::uint16_t);
+                    std::memcpy(halves, data, getVertexFormatSize(format));
+                    for (std::size_t i = 0; i < count; ++i)
+                        result.v[i] = halfToFloat(halves[i]);
+                    break;
+                }
+                case VertexFormat::unorm8x4:
+                    for (std::size_t i = 0; i < 4; ++i)
+                        result.v[i] = static_cast<float>(data[i]) / 255.0F;
+                    break;
+                case VertexFormat::snorm8x4:
+                    for (std::size_t i = 0; i < 4; ++i)
+                    {
+                        const auto value = static_cast<float>(static_cast<std::int8_t>(data[i])) / 127.0F;
+                        result.v[i] = value < -1.0F ? -1.0F : value;
+                    }
+                    break;
+            }
+
+            return result;
+        }
+    }
+}
+
+#endif
@@ -6,17 +6,37 @@
 #define SR_HPP
 
 #include "BlendState.hpp"
+#include "BoundingVolume.hpp"
+#include "Cluster.hpp"
 #include "Color.hpp"
+#include "ConstantBuffer.hpp"
+#include "CommandBuffer.hpp"
+#include "CommandQueue.hpp"
 #include "Constants.hpp"
+#include "CullMode.hpp"
 #include "DepthState.hpp"
+#include "DrawCall.hpp"
+#include "Frustum.hpp"
+#include "IndexBufferView.hpp"
+#include "Instance.hpp"
+#include "JobSystem.hpp"
 #include "Matrix.hpp"
+#include "OcclusionBuffer.hpp"
+#include "PerformanceCounters.hpp"
+#include "PipelineStatistics.hpp"
+#include "PrimitiveTopology.hpp"
+#include "Query.hpp"
 #include "Rect.hpp"
 #include "Renderer.hpp"
+#include "RenderPass.hpp"
 #include "Sampler.hpp"
 #include "Shader.hpp"
 #include "Size.hpp"
 #include "Texture.hpp"
+#include "TextureView.hpp"
+#include "Trace.hpp"
 #include "Vector.hpp"
 #include "Vertex.hpp"
+#include "VertexLayout.hpp"
 
 #endif
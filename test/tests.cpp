@@ -1,8 +1,2141 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
 #include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <utility>
 #include <vector>
 #include "catch2/catch.hpp"
 #include "sr.hpp"
+#include "../demo/Bmp.hpp"
 
 TEST_CASE("Test", "[test]")
 {
 }
+
+namespace
+{
+    sr::VertexShaderOutput colorVertexShader(const sr::Matrix<float, 4>& modelViewProjection,
+                                             const sr::Vertex& vertex,
+                                             const sr::Instance&,
+                                             const sr::ConstantBuffer&)
+    {
+        sr::VertexShaderOutput result;
+        result.position = modelViewProjection * vertex.position;
+        result.color = vertex.color;
+        return result;
+    }
+
+    sr::Color colorFragmentShader(const sr::VertexShaderOutput& input,
+                                  const std::array<const sr::Sampler*, 2>&,
+                                  const std::array<sr::TextureView, 2>&,
+                                  const sr::ConstantBuffer&)
+    {
+        return input.color;
+    }
+
+    // two overlapping quads in normalized device coordinates, the red one is in front
+    const std::vector<std::uint16_t> quadIndices{
+        0, 1, 2, 1, 3, 2,
+        4, 5, 6, 5, 7, 6
+    };
+
+    const std::vector<sr::Vertex> quadVertices{
+        sr::Vertex{sr::Vector<float, 4>{-0.8F, -0.8F, 0.5F, 1.0F}, sr::Color{0x0000FFFFU}, sr::Vector<float, 2>{}, sr::Vector<float, 3>{}},
+        sr::Vertex{sr::Vector<float, 4>{-0.8F, 0.4F, 0.5F, 1.0F}, sr::Color{0x0000FFFFU}, sr::Vector<float, 2>{}, sr::Vector<float, 3>{}},
+        sr::Vertex{sr::Vector<float, 4>{0.4F, -0.8F, 0.5F, 1.0F}, sr::Color{0x0000FFFFU}, sr::Vector<float, 2>{}, sr::Vector<float, 3>{}},
+        sr::Vertex{sr::Vector<float, 4>{0.4F, 0.4F, 0.5F, 1.0F}, sr::Color{0x0000FFFFU}, sr::Vector<float, 2>{}, sr::Vector<float, 3>{}},
+        sr::Vertex{sr::Vector<float, 4>{-0.4F, -0.4F, 0.2F, 1.0F}, sr::Color{0xFF0000FFU}, sr::Vector<float, 2>{}, sr::Vector<float, 3>{}},
+        sr::Vertex{sr::Vector<float, 4>{-0.4F, 0.8F, 0.2F, 1.0F}, sr::Color{0xFF0000FFU}, sr::Vector<float, 2>{}, sr::Vector<float, 3>{}},
+        sr::Vertex{sr::Vector<float, 4>{0.8F, -0.4F, 0.2F, 1.0F}, sr::Color{0xFF0000FFU}, sr::Vector<float, 2>{}, sr::Vector<float, 3>{}},
+        sr::Vertex{sr::Vector<float, 4>{0.8F, 0.8F, 0.2F, 1.0F}, sr::Color{0xFF0000FFU}, sr::Vector<float, 2>{}, sr::Vector<float, 3>{}}
+    };
+
+    sr::DrawCall getQuadDrawCall(const std::size_t width, const std::size_t height)
+    {
+        sr::DrawCall drawCall;
+        drawCall.vertexShader = colorVertexShader;
+        drawCall.fragmentShader = colorFragmentShader;
+        drawCall.viewport = sr::Rect<float>{0.0F, 0.0F, static_cast<float>(width), static_cast<float>(height)};
+        drawCall.depthState.read = true;
+        drawCall.depthState.write = true;
+        drawCall.indices = quadIndices;
+        drawCall.vertices = &quadVertices;
+        return drawCall;
+    }
+
+    std::uint32_t getPixel(const sr::Texture& texture, const std::size_t x, const std::size_t y)
+    {
+        return reinterpret_cast<const std::uint32_t*>(texture.getData().data())[y * texture.getWidth() + x];
+    }
+}
+
+TEST_CASE("Render pass load actions", "[renderpass]")
+{
+    sr::Texture frameBuffer{sr::PixelFormat::rgba8, 32, 32};
+    sr::Texture depthBuffer{sr::PixelFormat::float32, 32, 32};
+
+    clear(frameBuffer, sr::Color{0U, 255U, 0U, 255U});
+    clear(depthBuffer, 0.0F);
+
+    sr::RenderPass renderPass;
+    renderPass.colorAttachment.texture = &frameBuffer;
+    renderPass.depthAttachment.texture = &depthBuffer;
+
+    SECTION("Load")
+    {
+        // everything fails the loaded depth test
+        drawTriangles(renderPass, {getQuadDrawCall(32, 32)});
+        REQUIRE(getPixel(frameBuffer, 16, 16) == sr::Color{0U, 255U, 0U, 255U}.getIntValueRaw());
+    }
+
+    SECTION("Clear")
+    {
+        renderPass.colorAttachment.loadAction = sr::RenderPass::LoadAction::clear;
+        renderPass.colorAttachment.clearColor = sr::Color{255U, 255U, 255U, 255U};
+        renderPass.depthAttachment.loadAction = sr::RenderPass::LoadAction::clear;
+        renderPass.depthAttachment.clearDepth = 1.0F;
+
+        drawTriangles(renderPass, {getQuadDrawCall(32, 32)});
+        REQUIRE(getPixel(frameBuffer, 0, 0) == sr::Color{255U, 255U, 255U, 255U}.getIntValueRaw());
+        REQUIRE(getPixel(frameBuffer, 16, 16) == sr::Color{255U, 0U, 0U, 255U}.getIntValueRaw());
+        REQUIRE(getPixel(frameBuffer, 8, 8) == sr::Color{0U, 0U, 255U, 255U}.getIntValueRaw());
+    }
+}
+
+TEST_CASE("Tiled render pass", "[renderpass]")
+{
+    constexpr std::size_t width = 50;
+    constexpr std::size_t height = 40;
+
+    sr::Texture immediateFrameBuffer{sr::PixelFormat::rgba8, width, height};
+    sr::Texture immediateDepthBuffer{sr::PixelFormat::float32, width, height};
+
+    sr::RenderPass immediatePass;
+    immediatePass.colorAttachment.texture = &immediateFrameBuffer;
+    immediatePass.colorAttachment.loadAction = sr::RenderPass::LoadAction::clear;
+    immediatePass.depthAttachment.texture = &immediateDepthBuffer;
+    immediatePass.depthAttachment.loadAction = sr::RenderPass::LoadAction::clear;
+    drawTriangles(immediatePass, {getQuadDrawCall(width, height)});
+
+    sr::Texture tiledFrameBuffer{sr::PixelFormat::rgba8, width, height};
+    sr::Texture tiledDepthBuffer{sr::PixelFormat::float32, width, height};
+    clear(tiledDepthBuffer, 42.0F);
+
+    sr::RenderPass tiledPass;
+    tiledPass.colorAttachment.texture = &tiledFrameBuffer;
+    tiledPass.colorAttachment.loadAction = sr::RenderPass::LoadAction::clear;
+    tiledPass.depthAttachment.texture = &tiledDepthBuffer;
+    tiledPass.depthAttachment.loadAction = sr::RenderPass::LoadAction::clear;
+    tiledPass.depthAttachment.storeAction = sr::RenderPass::StoreAction::discard;
+    tiledPass.tileSize = 16;
+    drawTriangles(tiledPass, {getQuadDrawCall(width, height)});
+
+    REQUIRE(tiledFrameBuffer.getData() == immediateFrameBuffer.getData());
+
+    // the discarded depth was never written back
+    const auto depthData = reinterpret_cast<const float*>(tiledDepthBuffer.getData().data());
+    REQUIRE(std::all_of(depthData, depthData + width * height, [](float depth) { return depth == 42.0F; }));
+
+    // the depth does not need a texture at all if it is not loaded or stored
+    tiledPass.depthAttachment.texture = nullptr;
+    drawTriangles(tiledPass, {getQuadDrawCall(width, height)});
+    REQUIRE(tiledFrameBuffer.getData() == immediateFrameBuffer.getData());
+
+    tiledPass.depthAttachment.storeAction = sr::RenderPass::StoreAction::store;
+    REQUIRE_THROWS_AS(drawTriangles(tiledPass, {getQuadDrawCall(width, height)}), sr::RenderError);
+}
+
+namespace
+{
+    std::size_t fragmentShaderInvocations = 0;
+
+    sr::Color countingFragmentShader(const sr::VertexShaderOutput& input,
+                                     const std::array<const sr::Sampler*, 2>&,
+                                     const std::array<sr::TextureView, 2>&,
+                                     const sr::ConstantBuffer&)
+    {
+        ++fragmentShaderInvocations;
+        return input.color;
+    }
+}
+
+TEST_CASE("Multisampling", "[multisampling]")
+{
+    constexpr std::size_t width = 32;
+    constexpr std::size_t height = 32;
+
+    const std::vector<std::uint16_t> indices{0, 1, 2};
+    const std::vector<sr::Vertex> vertices{
+        sr::Vertex{sr::Vector<float, 4>{-0.9F, -0.9F, 0.5F, 1.0F}, sr::Color{0x000000FFU}, sr::Vector<float, 2>{}, sr::Vector<float, 3>{}},
+        sr::Vertex{sr::Vector<float, 4>{-0.9F, 0.9F, 0.5F, 1.0F}, sr::Color{0x000000FFU}, sr::Vector<float, 2>{}, sr::Vector<float, 3>{}},
+        sr::Vertex{sr::Vector<float, 4>{0.7F, -0.6F, 0.5F, 1.0F}, sr::Color{0x000000FFU}, sr::Vector<float, 2>{}, sr::Vector<float, 3>{}}
+    };
+
+    auto drawCall = getQuadDrawCall(width, height);
+    drawCall.fragmentShader = countingFragmentShader;
+    drawCall.indices = indices;
+    drawCall.vertices = &vertices;
+
+    sr::Texture singleSampleFrameBuffer{sr::PixelFormat::rgba8, width, height};
+    sr::RenderPass singleSamplePass;
+    singleSamplePass.colorAttachment.texture = &singleSampleFrameBuffer;
+    singleSamplePass.colorAttachment.loadAction = sr::RenderPass::LoadAction::clear;
+    singleSamplePass.colorAttachment.clearColor = sr::Color{255U, 255U, 255U, 255U};
+    singleSamplePass.depthAttachment.loadAction = sr::RenderPass::LoadAction::clear;
+    singleSamplePass.depthAttachment.storeAction = sr::RenderPass::StoreAction::discard;
+
+    fragmentShaderInvocations = 0;
+    drawTriangles(singleSamplePass, {drawCall});
+    const auto singleSampleInvocations = fragmentShaderInvocations;
+
+    sr::Texture multisampleFrameBuffer{sr::PixelFormat::rgba8, width, height, false, 4};
+    sr::Texture resolvedFrameBuffer{sr::PixelFormat::rgba8, width, height};
+    sr::RenderPass multisamplePass = singleSamplePass;
+    multisamplePass.colorAttachment.texture = &multisampleFrameBuffer;
+    multisamplePass.colorAttachment.resolveTexture = &resolvedFrameBuffer;
+
+    fragmentShaderInvocations = 0;
+    drawTriangles(multisamplePass, {drawCall});
+    const auto multisampleInvocations = fragmentShaderInvocations;
+
+    // the fragment shader runs once per pixel, only the edge pixels are added
+    REQUIRE(multisampleInvocations >= singleSampleInvocations);
+    REQUIRE(multisampleInvocations < singleSampleInvocations + singleSampleInvocations / 2);
+
+    std::size_t partiallyCovered = 0;
+    for (std::size_t y = 0; y < height; ++y)
+        for (std::size_t x = 0; x < width; ++x)
+        {
+            const auto pixel = reinterpret_cast<const std::uint8_t*>(&resolvedFrameBuffer.getData()[(y * width + x) * 4]);
+            if (pixel[0] != 0 && pixel[0] != 255) ++partiallyCovered;
+        }
+
+    REQUIRE(partiallyCovered > 0);
+
+    // interior is fully covered
+    REQUIRE(getPixel(resolvedFrameBuffer, 4, 16) == getPixel(singleSampleFrameBuffer, 4, 16));
+    REQUIRE(getPixel(resolvedFrameBuffer, 31, 31) == sr::Color{255U, 255U, 255U, 255U}.getIntValueRaw());
+
+    // tiled rendering resolves from the tile buffers
+    sr::Texture tiledResolvedFrameBuffer{sr::PixelFormat::rgba8, width, height};
+    multisamplePass.colorAttachment.storeAction = sr::RenderPass::StoreAction::discard;
+    multisamplePass.colorAttachment.resolveTexture = &tiledResolvedFrameBuffer;
+    multisamplePass.tileSize = 8;
+    drawTriangles(multisamplePass, {drawCall});
+
+    REQUIRE(tiledResolvedFrameBuffer.getData() == resolvedFrameBuffer.getData());
+
+    sr::Texture explicitResolve{sr::PixelFormat::rgba8, width, height};
+    multisamplePass.colorAttachment.storeAction = sr::RenderPass::StoreAction::store;
+    drawTriangles(multisamplePass, {drawCall});
+    resolve(multisampleFrameBuffer, explicitResolve);
+    REQUIRE(explicitResolve.getData() == resolvedFrameBuffer.getData());
+}
+
+TEST_CASE("Command buffer", "[commandbuffer]")
+{
+    constexpr std::size_t width = 32;
+    constexpr std::size_t height = 32;
+
+    const auto near = sr::Matrix<float, 4>::identity();
+    auto far = sr::Matrix<float, 4>::identity();
+    far.m[14] = 0.3F;
+
+    sr::DepthState depthState;
+    depthState.read = true;
+    depthState.write = true;
+
+    sr::CommandBuffer commandBuffer;
+    commandBuffer.setShaders(colorVertexShader, colorFragmentShader);
+    commandBuffer.setViewport(sr::Rect<float>{0.0F, 0.0F, static_cast<float>(width), static_cast<float>(height)});
+    commandBuffer.setDepthState(depthState);
+    commandBuffer.drawTriangles(quadIndices, quadVertices, far);
+    commandBuffer.drawTriangles(quadIndices, quadVertices, near);
+
+    REQUIRE(commandBuffer.getDrawCount() == 2);
+
+    std::vector<sr::DrawCall> drawCalls;
+    commandBuffer.getDrawCalls(drawCalls);
+    REQUIRE(drawCalls.size() == 2);
+    REQUIRE(sr::getSortDepth(drawCalls[0]) == 0.3F);
+
+    // the closer draw goes first
+    sr::sortDrawCalls(drawCalls);
+    REQUIRE(sr::getSortDepth(drawCalls[0]) == 0.0F);
+
+    // blended draws are never reordered
+    drawCalls[0].blendState.enabled = true;
+    sr::sortDrawCalls(drawCalls);
+    REQUIRE(drawCalls[0].blendState.enabled);
+    drawCalls[0].blendState.enabled = false;
+
+    // neither are draws with queries or predicates
+    sr::Query query{sr::QueryType::samplesPassed};
+    std::swap(drawCalls[0], drawCalls[1]);
+    drawCalls[0].query = &query;
+    sr::sortDrawCalls(drawCalls);
+    REQUIRE(sr::getSortDepth(drawCalls[0]) == 0.3F);
+    drawCalls[0].query = nullptr;
+    drawCalls[0].predicate = &query;
+    REQUIRE_FALSE(sr::isReorderable(drawCalls[0]));
+
+    sr::Texture immediateFrameBuffer{sr::PixelFormat::rgba8, width, height};
+    sr::RenderPass renderPass;
+    renderPass.colorAttachment.texture = &immediateFrameBuffer;
+    renderPass.colorAttachment.loadAction = sr::RenderPass::LoadAction::clear;
+    renderPass.depthAttachment.loadAction = sr::RenderPass::LoadAction::clear;
+    renderPass.depthAttachment.storeAction = sr::RenderPass::StoreAction::discard;
+    sr::execute(renderPass, {&commandBuffer}, false);
+
+    // sorting reorderable draws does not change the image
+    sr::Texture queuedFrameBuffer{sr::PixelFormat::rgba8, width, height};
+    renderPass.colorAttachment.texture = &queuedFrameBuffer;
+
+    sr::CommandQueue commandQueue;
+    commandQueue.submit(renderPass, {commandBuffer});
+    commandQueue.waitIdle();
+    REQUIRE(commandQueue.isIdle());
+    REQUIRE(queuedFrameBuffer.getData() == immediateFrameBuffer.getData());
+
+    // errors are reported on the waiting thread
+    renderPass.colorAttachment.texture = nullptr;
+    commandQueue.submit(renderPass, {commandBuffer});
+    REQUIRE_THROWS_AS(commandQueue.waitIdle(), sr::RenderError);
+}
+
+TEST_CASE("Index buffers", "[indexbuffer]")
+{
+    constexpr std::size_t width = 32;
+    constexpr std::size_t height = 32;
+
+    const std::vector<std::uint32_t> indices32(quadIndices.begin(), quadIndices.end());
+
+    const sr::IndexBufferView view16{quadIndices};
+    const sr::IndexBufferView view32{indices32};
+    REQUIRE(view16.getType() == sr::IndexType::uint16);
+    REQUIRE(view32.getType() == sr::IndexType::uint32);
+    REQUIRE(view32.getSize() == quadIndices.size());
+    REQUIRE(view32[5] == quadIndices[5]);
+
+    const auto render = [](const sr::IndexBufferView& indices) {
+        sr::Texture frameBuffer{sr::PixelFormat::rgba8, width, height};
+        sr::Texture depthBuffer{sr::PixelFormat::float32, width, height};
+
+        sr::RenderPass renderPass;
+        renderPass.colorAttachment.texture = &frameBuffer;
+        renderPass.colorAttachment.loadAction = sr::RenderPass::LoadAction::clear;
+        renderPass.depthAttachment.texture = &depthBuffer;
+        renderPass.depthAttachment.loadAction = sr::RenderPass::LoadAction::clear;
+
+        auto drawCall = getQuadDrawCall(width, height);
+        drawCall.indices = indices;
+        drawTriangles(renderPass, {drawCall});
+        return frameBuffer.getData();
+    };
+
+    // both index types and memory that is not a vector draw the same triangles
+    const auto image = render(view16);
+    REQUIRE(render(view32) == image);
+    REQUIRE(render(sr::IndexBufferView{indices32.data(), indices32.size()}) == image);
+
+    // only the first quad
+    REQUIRE(render(sr::IndexBufferView{quadIndices.data(), 6}) != image);
+
+    REQUIRE(render(sr::IndexBufferView{}) == render(sr::IndexBufferView{quadIndices.data(), 0}));
+}
+
+TEST_CASE("Primitive topologies", "[indexbuffer]")
+{
+    constexpr std::size_t width = 32;
+    constexpr std::size_t height = 32;
+
+    const auto render = [](const sr::PrimitiveTopology topology,
+                           const bool primitiveRestart,
+                           const std::vector<std::uint16_t>& indices,
+                           sr::PipelineStatistics* statistics = nullptr) {
+        sr::Texture frameBuffer{sr::PixelFormat::rgba8, width, height};
+        sr::Texture depthBuffer{sr::PixelFormat::float32, width, height};
+
+        sr::RenderPass renderPass;
+        renderPass.colorAttachment.texture = &frameBuffer;
+        renderPass.colorAttachment.loadAction = sr::RenderPass::LoadAction::clear;
+        renderPass.depthAttachment.texture = &depthBuffer;
+        renderPass.depthAttachment.loadAction = sr::RenderPass::LoadAction::clear;
+
+        auto drawCall = getQuadDrawCall(width, height);
+        drawCall.topology = topology;
+        drawCall.primitiveRestart = primitiveRestart;
+        drawCall.indices = indices;
+
+        std::vector<sr::PipelineStatistics> drawStatistics;
+        drawTriangles(renderPass, {drawCall}, nullptr, &drawStatistics);
+        if (statistics) *statistics = drawStatistics[0];
+        return frameBuffer.getData();
+    };
+
+    // the vertices of a triangle in a different order can change the interpolated colors by a rounding step
+    const auto isClose = [](const std::vector<std::uint8_t>& a, const std::vector<std::uint8_t>& b) {
+        for (std::size_t i = 0; i < a.size(); ++i)
+            if (std::abs(a[i] - b[i]) > 1) return false;
+        return a.size() == b.size();
+    };
+
+    const auto image = render(sr::PrimitiveTopology::triangleList, false, quadIndices);
+
+    // the second triangle of a strip is flipped, so the strip covers the same pixels as the list
+    sr::PipelineStatistics statistics;
+    REQUIRE(isClose(render(sr::PrimitiveTopology::triangleStrip, true, {0, 1, 2, 3, 0xFFFF, 4, 5, 6, 7}, &statistics), image));
+    REQUIRE(statistics.trianglesSubmitted == 4);
+
+    REQUIRE(render(sr::PrimitiveTopology::triangleStrip, false, {0, 1, 2, 3}) ==
+            render(sr::PrimitiveTopology::triangleList, false, {0, 1, 2, 2, 1, 3}));
+
+    REQUIRE(isClose(render(sr::PrimitiveTopology::triangleFan, true, {0, 1, 3, 2, 0xFFFF, 4, 5, 7, 6}, &statistics), image));
+    REQUIRE(statistics.trianglesSubmitted == 4);
+
+    // too few indices for a triangle
+    REQUIRE(render(sr::PrimitiveTopology::triangleStrip, true, {0, 1, 0xFFFF, 2, 3}, &statistics) ==
+            render(sr::PrimitiveTopology::triangleList, false, {}));
+    REQUIRE(statistics.trianglesSubmitted == 0);
+
+    SECTION("Batches")
+    {
+        // strips that cross the boundaries of the setup batches
+        std::vector<std::uint32_t> indices;
+        std::vector<sr::Vertex> vertices;
+        for (std::uint32_t strip = 0; strip < 7; ++strip)
+        {
+            for (std::uint32_t i = 0; i < 500; ++i)
+            {
+                indices.push_back(static_cast<std::uint32_t>(vertices.size()));
+                const auto x = static_cast<float>(i / 2) / 125.0F - 1.0F;
+                const auto y = static_cast<float>(strip) / 3.5F - 1.0F + static_cast<float>(i % 2) / 4.0F;
+                vertices.push_back(sr::Vertex{sr::Vector<float, 4>{x, y, 0.5F, 1.0F}, sr::Color{0xFFFFFFFFU}, sr::Vector<float, 2>{}, sr::Vector<float, 3>{}});
+            }
+            indices.push_back(0xFFFFFFFFU);
+        }
+
+        sr::Texture frameBuffer{sr::PixelFormat::rgba8, width, height};
+        sr::RenderPass renderPass;
+        renderPass.colorAttachment.texture = &frameBuffer;
+        renderPass.depthAttachment.loadAction = sr::RenderPass::LoadAction::dontCare;
+        renderPass.depthAttachment.storeAction = sr::RenderPass::StoreAction::discard;
+
+        auto drawCall = getQuadDrawCall(width, height);
+        drawCall.depthState = sr::DepthState{};
+        drawCall.topology = sr::PrimitiveTopology::triangleStrip;
+        drawCall.primitiveRestart = true;
+        drawCall.indices = indices;
+        drawCall.vertices = &vertices;
+
+        sr::JobSystem jobSystem{3};
+        std::vector<sr::PipelineStatistics> serial;
+        std::vector<sr::PipelineStatistics> parallel;
+        drawTriangles(renderPass, {drawCall}, nullptr, &serial);
+        drawTriangles(renderPass, {drawCall}, &jobSystem, &parallel);
+
+        REQUIRE(serial[0].trianglesSubmitted == 7 * 498);
+        REQUIRE(parallel[0].trianglesSubmitted == serial[0].trianglesSubmitted);
+        REQUIRE(parallel[0].trianglesCulled == serial[0].trianglesCulled);
+        REQUIRE(parallel[0].pixelsCovered == serial[0].pixelsCovered);
+    }
+}
+
+namespace
+{
+    sr::VertexShaderOutput instanceVertexShader(const sr::Matrix<float, 4>& modelViewProjection,
+                                                const sr::Vertex& vertex,
+                                                const sr::Instance& instance,
+                                                const sr::ConstantBuffer&)
+    {
+        sr::VertexShaderOutput result;
+        result.position = modelViewProjection * vertex.position;
+        result.color = instance.color;
+        return result;
+    }
+}
+
+TEST_CASE("Instancing", "[instancing]")
+{
+    constexpr std::size_t width = 32;
+    constexpr std::size_t height = 32;
+
+    sr::Texture frameBuffer{sr::PixelFormat::rgba8, width, height};
+    sr::Texture depthBuffer{sr::PixelFormat::float32, width, height};
+
+    sr::RenderPass renderPass;
+    renderPass.colorAttachment.texture = &frameBuffer;
+    renderPass.colorAttachment.loadAction = sr::RenderPass::LoadAction::clear;
+    renderPass.depthAttachment.texture = &depthBuffer;
+    renderPass.depthAttachment.loadAction = sr::RenderPass::LoadAction::clear;
+
+    // the blue quad
+    auto drawCall = getQuadDrawCall(width, height);
+    drawCall.vertexShader = instanceVertexShader;
+    drawCall.indices = sr::IndexBufferView{quadIndices.data(), 6};
+
+    std::vector<sr::Instance> instances(2);
+    instances[0].color = sr::Color{0U, 255U, 0U, 255U};
+    instances[1].transform.setTranslation(0.4F, 0.4F, 0.0F);
+    instances[1].color = sr::Color{255U, 0U, 0U, 255U};
+    drawCall.instances = &instances;
+
+    std::vector<sr::PipelineStatistics> statistics;
+    drawTriangles(renderPass, {drawCall}, nullptr, &statistics);
+
+    REQUIRE(getPixel(frameBuffer, 4, 4) == sr::Color{0U, 255U, 0U, 255U}.getIntValueRaw());
+    REQUIRE(getPixel(frameBuffer, 28, 28) == sr::Color{255U, 0U, 0U, 255U}.getIntValueRaw());
+    REQUIRE(getPixel(frameBuffer, 0, 0) == 0);
+    // only the vertices of the blue quad are shaded
+    REQUIRE(statistics[0].vertexShaderInvocations == 4 * instances.size());
+    REQUIRE(statistics[0].trianglesSubmitted == 2 * instances.size());
+
+    // the same as a draw per instance
+    const auto image = frameBuffer.getData();
+    const std::vector<sr::Instance> first{instances[0]};
+    const std::vector<sr::Instance> second{instances[1]};
+    auto firstDrawCall = drawCall;
+    firstDrawCall.instances = &first;
+    auto secondDrawCall = drawCall;
+    secondDrawCall.instances = &second;
+    drawTriangles(renderPass, {firstDrawCall, secondDrawCall});
+    REQUIRE(frameBuffer.getData() == image);
+
+    SECTION("Threads")
+    {
+        // enough instances to be distributed between the threads, each of them at its own depth
+        std::vector<sr::Instance> grid;
+        for (std::size_t i = 0; i < 1000; ++i)
+        {
+            sr::Instance instance;
+            instance.transform.setScale(0.1F, 0.1F, 1.0F);
+            sr::Matrix<float, 4> translation;
+            translation.setTranslation(static_cast<float>(i % 31) / 16.0F - 0.9F,
+                                       static_cast<float>(i / 31 % 31) / 16.0F - 0.9F,
+                                       static_cast<float>(i) / 2000.0F - 0.25F);
+            instance.transform = translation * instance.transform;
+            instance.color = sr::Color{static_cast<std::uint32_t>(i * 0x01020300U) | 0xFFU};
+            grid.push_back(instance);
+        }
+        drawCall.instances = &grid;
+
+        sr::JobSystem jobSystem{3};
+        std::vector<sr::PipelineStatistics> serial;
+        std::vector<sr::PipelineStatistics> parallel;
+
+        drawTriangles(renderPass, {drawCall}, nullptr, &serial);
+        const auto serialImage = frameBuffer.getData();
+        drawTriangles(renderPass, {drawCall}, &jobSystem, &parallel);
+        REQUIRE(frameBuffer.getData() == serialImage);
+
+        renderPass.tileSize = 8;
+        drawTriangles(renderPass, {drawCall}, &jobSystem);
+        REQUIRE(frameBuffer.getData() == serialImage);
+
+        REQUIRE(serial[0].vertexShaderInvocations == 4 * grid.size());
+        REQUIRE(parallel[0].vertexShaderInvocations == serial[0].vertexShaderInvocations);
+        REQUIRE(parallel[0].trianglesSubmitted == 2 * grid.size());
+        REQUIRE(parallel[0].pixelsCovered == serial[0].pixelsCovered);
+    }
+}
+
+namespace
+{
+    sr::VertexShaderOutput attributeVertexShader(const sr::Matrix<float, 4>& modelViewProjection,
+                                                 const sr::Vertex& vertex,
+                                                 const sr::Instance&,
+                                                 const sr::ConstantBuffer&)
+    {
+        sr::VertexShaderOutput result;
+        result.position = modelViewProjection * vertex.position;
+        result.color = sr::Color{vertex.texCoords[0].v[0], vertex.texCoords[0].v[1], -vertex.normal.v[2], 1.0F};
+        return result;
+    }
+}
+
+TEST_CASE("Vertex layouts", "[vertexlayout]")
+{
+    constexpr std::size_t width = 32;
+    constexpr std::size_t height = 32;
+
+    REQUIRE(sr::detail::halfToFloat(0x3C00U) == 1.0F);
+    REQUIRE(sr::detail::halfToFloat(0xC000U) == -2.0F);
+    REQUIRE(sr::detail::halfToFloat(0x7BFFU) == 65504.0F);
+    REQUIRE(sr::detail::halfToFloat(0x0001U) == 1.0F / 16777216.0F);
+
+    sr::Texture frameBuffer{sr::PixelFormat::rgba8, width, height};
+    sr::Texture depthBuffer{sr::PixelFormat::float32, width, height};
+
+    sr::RenderPass renderPass;
+    renderPass.colorAttachment.texture = &frameBuffer;
+    renderPass.colorAttachment.loadAction = sr::RenderPass::LoadAction::clear;
+    renderPass.depthAttachment.texture = &depthBuffer;
+    renderPass.depthAttachment.loadAction = sr::RenderPass::LoadAction::clear;
+
+    drawTriangles(renderPass, {getQuadDrawCall(width, height)});
+    const auto image = frameBuffer.getData();
+
+    // positions and 8-bit colors in separate streams
+    std::vector<float> positions;
+    std::vector<std::uint8_t> colors;
+    for (const auto& vertex : quadVertices)
+    {
+        positions.insert(positions.end(), vertex.position.v.begin(), vertex.position.v.begin() + 3);
+        const auto color = vertex.color.getIntValue();
+        colors.insert(colors.end(), {
+            static_cast<std::uint8_t>(color >> 24), static_cast<std::uint8_t>(color >> 16),
+            static_cast<std::uint8_t>(color >> 8), static_cast<std::uint8_t>(color)
+        });
+    }
+
+    const sr::VertexLayout layout{{
+        {sr::VertexAttribute::position, sr::VertexFormat::float3, 0, 0},
+        {sr::VertexAttribute::color, sr::VertexFormat::unorm8x4, 1, 0}
+    }};
+
+    auto drawCall = getQuadDrawCall(width, height);
+    drawCall.vertices = nullptr;
+    drawCall.vertexLayout = &layout;
+    drawCall.vertexStreams[0] = sr::VertexStream{positions.data(), 3 * sizeof(float), positions.size() * sizeof(float)};
+    drawCall.vertexStreams[1] = sr::VertexStream{colors.data(), 4, colors.size()};
+    drawCall.vertexCount = quadVertices.size();
+
+    drawTriangles(renderPass, {drawCall});
+    REQUIRE(frameBuffer.getData() == image);
+
+    // the colors are not fetched if the shader does not declare them
+    drawCall.vertexShaderInputs = sr::getMask(sr::VertexAttribute::position);
+    drawTriangles(renderPass, {drawCall});
+    REQUIRE(getPixel(frameBuffer, 16, 16) == 0);
+
+    SECTION("Packed attributes")
+    {
+        // interleaved position, half-float texture coordinates and a packed normal
+        struct PackedVertex
+        {
+            float position[3];
+            std::uint16_t texCoord[2];
+            std::int8_t normal[4];
+        };
+
+        const std::vector<PackedVertex> vertices{
+            {{-1.0F, -1.0F, 0.5F}, {0x3800U, 0x3400U}, {0, 0, -127, 0}},
+            {{-1.0F, 1.0F, 0.5F}, {0x3800U, 0x3400U}, {0, 0, -127, 0}},
+            {{1.0F, -1.0F, 0.5F}, {0x3800U, 0x3400U}, {0, 0, -127, 0}},
+            {{1.0F, 1.0F, 0.5F}, {0x3800U, 0x3400U}, {0, 0, -127, 0}}
+        };
+
+        const sr::VertexLayout packedLayout{{
+            {sr::VertexAttribute::position, sr::VertexFormat::float3, 0, offsetof(PackedVertex, position)},
+            {sr::VertexAttribute::texCoord0, sr::VertexFormat::half2, 0, offsetof(PackedVertex, texCoord)},
+            {sr::VertexAttribute::normal, sr::VertexFormat::snorm8x4, 0, offsetof(PackedVertex, normal)}
+        }};
+
+        auto packedDrawCall = getQuadDrawCall(width, height);
+        packedDrawCall.vertexShader = attributeVertexShader;
+        packedDrawCall.vertices = nullptr;
+        packedDrawCall.vertexLayout = &packedLayout;
+        packedDrawCall.vertexStreams[0] = sr::VertexStream{vertices.data(), sizeof(PackedVertex), vertices.size() * sizeof(PackedVertex)};
+        packedDrawCall.vertexCount = vertices.size();
+        packedDrawCall.indices = sr::IndexBufferView{quadIndices.data(), 6};
+
+        drawTriangles(renderPass, {packedDrawCall});
+        REQUIRE(getPixel(frameBuffer, 16, 16) == sr::Color{0.5F, 0.25F, 1.0F, 1.0F}.getIntValueRaw());
+    }
+
+    SECTION("Validation")
+    {
+        // the last vertex of the red quad is not in the streams
+        drawCall.vertexCount = quadVertices.size() - 1;
+        REQUIRE_THROWS_AS(drawTriangles(renderPass, {drawCall}), sr::RenderError);
+        drawCall.vertexCount = quadVertices.size();
+
+        auto listDrawCall = getQuadDrawCall(width, height);
+        const std::vector<std::uint16_t> indices{0, 1, 8};
+        listDrawCall.indices = indices;
+        REQUIRE_THROWS_AS(drawTriangles(renderPass, {listDrawCall}), sr::RenderError);
+
+        drawCall.vertexStreams[1] = sr::VertexStream{};
+        REQUIRE_THROWS_AS(drawTriangles(renderPass, {drawCall}), sr::RenderError);
+
+        drawCall.vertexStreams[1] = sr::VertexStream{colors.data(), 2, colors.size()};
+        REQUIRE_THROWS_AS(drawTriangles(renderPass, {drawCall}), sr::RenderError);
+
+        // one color short
+        drawCall.vertexStreams[1] = sr::VertexStream{colors.data(), 4, colors.size() - 4};
+        REQUIRE_THROWS_AS(drawTriangles(renderPass, {drawCall}), sr::RenderError);
+
+        // neither vertices nor a layout, e.g. streams recorded without setVertexLayout
+        sr::CommandBuffer commandBuffer;
+        commandBuffer.setShaders(colorVertexShader, colorFragmentShader);
+        commandBuffer.drawTriangles(quadIndices, drawCall.vertexStreams, quadVertices.size(), sr::Matrix<float, 4>::identity());
+        REQUIRE_THROWS_AS(sr::execute(renderPass, {&commandBuffer}), sr::RenderError);
+    }
+}
+
+namespace
+{
+    // the custom varying goes from 0 on the left to 1 on the right of the viewport
+    sr::VertexShaderOutput customVertexShader(const sr::Matrix<float, 4>& modelViewProjection,
+                                              const sr::Vertex& vertex,
+                                              const sr::Instance&,
+                                              const sr::ConstantBuffer&)
+    {
+        sr::VertexShaderOutput result;
+        result.position = modelViewProjection * vertex.position;
+        result.color = vertex.color;
+        result.varyings[1] = vertex.position.v[0] * 0.5F + 0.5F;
+        return result;
+    }
+
+    sr::Color customFragmentShader(const sr::VertexShaderOutput& input,
+                                   const std::array<const sr::Sampler*, 2>&,
+                                   const std::array<sr::TextureView, 2>&,
+                                   const sr::ConstantBuffer&)
+    {
+        return sr::Color{input.varyings[1], input.color.g, input.color.b, 1.0F};
+    }
+}
+
+TEST_CASE("Varyings", "[varyings]")
+{
+    constexpr std::size_t width = 32;
+    constexpr std::size_t height = 32;
+
+    sr::Texture frameBuffer{sr::PixelFormat::rgba8, width, height};
+
+    sr::RenderPass renderPass;
+    renderPass.colorAttachment.texture = &frameBuffer;
+    renderPass.colorAttachment.loadAction = sr::RenderPass::LoadAction::clear;
+    renderPass.depthAttachment.loadAction = sr::RenderPass::LoadAction::dontCare;
+    renderPass.depthAttachment.storeAction = sr::RenderPass::StoreAction::discard;
+
+    // the blue quad
+    auto drawCall = getQuadDrawCall(width, height);
+    drawCall.vertexShader = customVertexShader;
+    drawCall.fragmentShader = customFragmentShader;
+    drawCall.depthState = sr::DepthState{};
+    drawCall.indices = sr::IndexBufferView{quadIndices.data(), 6};
+    drawCall.customVaryingCount = 2;
+
+    drawTriangles(renderPass, {drawCall});
+    // red in the first byte and blue in the third
+    const auto left = getPixel(frameBuffer, 4, 16);
+    const auto right = getPixel(frameBuffer, 20, 16);
+    REQUIRE((left & 0xFFU) > 0U);
+    REQUIRE((right & 0xFFU) > (left & 0xFFU));
+    REQUIRE(((left >> 16) & 0xFFU) == 255U);
+
+    // the varyings that are not declared are zero
+    drawCall.customVaryingCount = 1;
+    drawCall.fragmentShaderInputs = sr::getMask(sr::Varying::texCoord0);
+    drawTriangles(renderPass, {drawCall});
+    REQUIRE(getPixel(frameBuffer, 20, 16) == sr::Color{0.0F, 0.0F, 0.0F, 1.0F}.getIntValueRaw());
+
+    drawCall.customVaryingCount = sr::maxCustomVaryings + 1;
+    REQUIRE_THROWS_AS(drawTriangles(renderPass, {drawCall}), sr::RenderError);
+}
+
+namespace
+{
+    class QuadConstants final
+    {
+    public:
+        float offsetX = 0.0F;
+        sr::Color color;
+    };
+
+    sr::VertexShaderOutput constantVertexShader(const sr::Matrix<float, 4>& modelViewProjection,
+                                                const sr::Vertex& vertex,
+                                                const sr::Instance&,
+                                                const sr::ConstantBuffer& constants)
+    {
+        sr::VertexShaderOutput result;
+        result.position = modelViewProjection * vertex.position;
+        result.position.v[0] += constants.get<QuadConstants>()->offsetX;
+        return result;
+    }
+
+    sr::Color constantFragmentShader(const sr::VertexShaderOutput&,
+                                     const std::array<const sr::Sampler*, 2>&,
+                                     const std::array<sr::TextureView, 2>&,
+                                     const sr::ConstantBuffer& constants)
+    {
+        return constants.get<QuadConstants>()->color;
+    }
+}
+
+TEST_CASE("Constant buffers", "[constantbuffer]")
+{
+    constexpr std::size_t width = 32;
+    constexpr std::size_t height = 32;
+
+    const QuadConstants leftConstants{-0.4F, sr::Color{255U, 0U, 0U}};
+    const QuadConstants rightConstants{0.4F, sr::Color{0U, 255U, 0U}};
+    const float small = 0.0F;
+
+    REQUIRE(sr::ConstantBuffer{leftConstants}.get<QuadConstants>() == &leftConstants);
+    REQUIRE(sr::ConstantBuffer{small}.get<QuadConstants>() == nullptr);
+    REQUIRE(sr::ConstantBuffer{}.get<float>() == nullptr);
+
+    sr::Texture frameBuffer{sr::PixelFormat::rgba8, width, height};
+
+    sr::RenderPass renderPass;
+    renderPass.colorAttachment.texture = &frameBuffer;
+    renderPass.colorAttachment.loadAction = sr::RenderPass::LoadAction::clear;
+    renderPass.depthAttachment.loadAction = sr::RenderPass::LoadAction::dontCare;
+    renderPass.depthAttachment.storeAction = sr::RenderPass::StoreAction::discard;
+    renderPass.tileSize = 8;
+
+    // the blue quad twice, every draw with its own constants
+    sr::CommandBuffer commandBuffer;
+    commandBuffer.setShaders(constantVertexShader, constantFragmentShader);
+    commandBuffer.setViewport(sr::Rect<float>{0.0F, 0.0F, static_cast<float>(width), static_cast<float>(height)});
+    commandBuffer.setConstantBuffer(sr::ConstantBuffer{leftConstants});
+    commandBuffer.drawTriangles(sr::IndexBufferView{quadIndices.data(), 6}, quadVertices, sr::Matrix<float, 4>::identity());
+    commandBuffer.setConstantBuffer(sr::ConstantBuffer{rightConstants});
+    commandBuffer.drawTriangles(sr::IndexBufferView{quadIndices.data(), 6}, quadVertices, sr::Matrix<float, 4>::identity());
+
+    sr::JobSystem jobSystem{2};
+    execute(renderPass, {&commandBuffer}, false, &jobSystem);
+
+    REQUIRE(getPixel(frameBuffer, 2, 10) == sr::Color{255U, 0U, 0U}.getIntValueRaw());
+    REQUIRE(getPixel(frameBuffer, 27, 10) == sr::Color{0U, 255U, 0U}.getIntValueRaw());
+    REQUIRE(getPixel(frameBuffer, 12, 10) == sr::Color{0U, 255U, 0U}.getIntValueRaw());
+}
+
+TEST_CASE("Frustum culling", "[frustum]")
+{
+    constexpr std::size_t width = 32;
+    constexpr std::size_t height = 32;
+
+    const sr::Frustum frustum{sr::Matrix<float, 4>::identity()};
+    REQUIRE(frustum.getContainment(sr::BoundingVolume::box(sr::Vector<float, 3>{-0.5F, -0.5F, 0.2F}, sr::Vector<float, 3>{0.5F, 0.5F, 0.8F})) == sr::Containment::inside);
+    REQUIRE(frustum.getContainment(sr::BoundingVolume::box(sr::Vector<float, 3>{0.5F, -0.5F, 0.2F}, sr::Vector<float, 3>{1.5F, 0.5F, 0.8F})) == sr::Containment::intersecting);
+    REQUIRE(frustum.getContainment(sr::BoundingVolume::box(sr::Vector<float, 3>{2.0F, -0.5F, 0.2F}, sr::Vector<float, 3>{3.0F, 0.5F, 0.8F})) == sr::Containment::outside);
+    REQUIRE(frustum.getContainment(sr::BoundingVolume::box(sr::Vector<float, 3>{-0.5F, -0.5F, -0.8F}, sr::Vector<float, 3>{0.5F, 0.5F, -0.2F})) == sr::Containment::outside);
+    REQUIRE(frustum.getContainment(sr::BoundingVolume::sphere(sr::Vector<float, 3>{0.0F, 0.0F, 0.5F}, 0.4F)) == sr::Containment::inside);
+    REQUIRE(frustum.getContainment(sr::BoundingVolume::sphere(sr::Vector<float, 3>{0.0F, 1.0F, 0.5F}, 0.4F)) == sr::Containment::intersecting);
+    REQUIRE(frustum.getContainment(sr::BoundingVolume::sphere(sr::Vector<float, 3>{0.0F, 0.0F, 1.5F}, 0.4F)) == sr::Containment::outside);
+    REQUIRE(frustum.getContainment(sr::BoundingVolume{}) == sr::Containment::intersecting);
+
+    sr::Texture frameBuffer{sr::PixelFormat::rgba8, width, height};
+    sr::Texture depthBuffer{sr::PixelFormat::float32, width, height};
+
+    sr::RenderPass renderPass;
+    renderPass.colorAttachment.texture = &frameBuffer;
+    renderPass.colorAttachment.loadAction = sr::RenderPass::LoadAction::clear;
+    renderPass.depthAttachment.texture = &depthBuffer;
+    renderPass.depthAttachment.loadAction = sr::RenderPass::LoadAction::clear;
+
+    drawTriangles(renderPass, {getQuadDrawCall(width, height)});
+    const auto image = frameBuffer.getData();
+
+    // the bounds of both quads, which are inside of the view
+    auto drawCall = getQuadDrawCall(width, height);
+    drawCall.bounds = sr::BoundingVolume::box(sr::Vector<float, 3>{-0.8F, -0.8F, 0.2F}, sr::Vector<float, 3>{0.8F, 0.8F, 0.5F});
+
+    auto hiddenDrawCall = drawCall;
+    hiddenDrawCall.modelViewProjection.setTranslation(3.0F, 0.0F, 0.0F);
+
+    std::vector<sr::PipelineStatistics> statistics;
+    drawTriangles(renderPass, {drawCall, hiddenDrawCall}, nullptr, &statistics);
+
+    REQUIRE(frameBuffer.getData() == image);
+    REQUIRE(statistics[0].objectsCulled == 0);
+    REQUIRE(statistics[0].vertexShaderInvocations == quadVertices.size());
+    REQUIRE(statistics[1].objectsCulled == 1);
+    REQUIRE(statistics[1].vertexShaderInvocations == 0);
+    REQUIRE(statistics[1].trianglesCulled == statistics[1].trianglesSubmitted);
+
+    SECTION("Instances")
+    {
+        // every instance is tested with its own transform
+        std::vector<sr::Instance> instances(3);
+        instances[1].transform.setTranslation(0.0F, -3.0F, 0.0F);
+        instances[2].transform.setTranslation(0.0F, 0.0F, 1.0F);
+
+        drawCall.instances = &instances;
+        drawTriangles(renderPass, {drawCall}, nullptr, &statistics);
+
+        REQUIRE(frameBuffer.getData() == image);
+        REQUIRE(statistics[0].objectsCulled == 2);
+        REQUIRE(statistics[0].vertexShaderInvocations == quadVertices.size());
+    }
+
+    SECTION("Command buffer")
+    {
+        sr::CommandBuffer commandBuffer;
+        commandBuffer.setShaders(colorVertexShader, colorFragmentShader);
+        commandBuffer.setViewport(drawCall.viewport);
+        commandBuffer.setDepthState(drawCall.depthState);
+        commandBuffer.drawTriangles(quadIndices, quadVertices, drawCall.modelViewProjection, drawCall.bounds);
+        commandBuffer.drawTriangles(quadIndices, quadVertices, hiddenDrawCall.modelViewProjection,
+                                    sr::BoundingVolume::sphere(sr::Vector<float, 3>{}, 1.2F));
+
+        std::vector<sr::DrawCall> drawCalls;
+        commandBuffer.getDrawCalls(drawCalls);
+        REQUIRE(drawCalls[1].bounds.type == sr::BoundingVolume::Type::sphere);
+
+        drawTriangles(renderPass, drawCalls, nullptr, &statistics);
+
+        REQUIRE(frameBuffer.getData() == image);
+        REQUIRE(statistics[1].objectsCulled == 1);
+    }
+}
+
+namespace
+{
+    // a cube of six faces with 4x4 quads each, the faces seen from the outside are front faces in a left-handed space
+    void getClusterCube(std::vector<std::uint16_t>& indices, std::vector<sr::Vertex>& vertices)
+    {
+        constexpr std::size_t quads = 4;
+        const sr::Color colors[] = {
+            sr::Color{255U, 0U, 0U}, sr::Color{0U, 255U, 0U}, sr::Color{0U, 0U, 255U},
+            sr::Color{255U, 255U, 0U}, sr::Color{0U, 255U, 255U}, sr::Color{255U, 0U, 255U}
+        };
+
+        for (std::size_t face = 0; face < 6; ++face)
+        {
+            // the normal and two axes of the face, v x u = normal
+            const auto axis = face % 3;
+            const auto sign = (face < 3) ? 1.0F : -1.0F;
+            sr::Vector<float, 3> normal;
+            normal.v[axis] = sign;
+            sr::Vector<float, 3> u;
+            u.v[(axis + 1) % 3] = 1.0F;
+            const auto v = u.cross(normal);
+
+            const auto first = static_cast<std::uint16_t>(vertices.size());
+            for (std::size_t y = 0; y <= quads; ++y)
+                for (std::size_t x = 0; x <= quads; ++x)
+                {
+                    const auto s = static_cast<float>(x) / quads * 2.0F - 1.0F;
+                    const auto t = static_cast<float>(y) / quads * 2.0F - 1.0F;
+                    const auto position = normal + u * s + v * t;
+                    vertices.push_back(sr::Vertex{sr::Vector<float, 4>{position.v[0], position.v[1], position.v[2], 1.0F},
+                                                  colors[face], sr::Vector<float, 2>{}, normal});
+                }
+
+            for (std::size_t y = 0; y < quads; ++y)
+                for (std::size_t x = 0; x < quads; ++x)
+                {
+                    const auto i = static_cast<std::uint16_t>(first + y * (quads + 1) + x);
+                    const auto row = static_cast<std::uint16_t>(quads + 1);
+                    indices.insert(indices.end(), {
+                        i, static_cast<std::uint16_t>(i + 1), static_cast<std::uint16_t>(i + row),
+                        static_cast<std::uint16_t>(i + 1), static_cast<std::uint16_t>(i + row + 1), static_cast<std::uint16_t>(i + row)
+                    });
+                }
+        }
+    }
+}
+
+TEST_CASE("Clusters", "[cluster]")
+{
+    constexpr std::size_t width = 32;
+    constexpr std::size_t height = 32;
+
+    std::vector<std::uint16_t> indices;
+    std::vector<sr::Vertex> vertices;
+    getClusterCube(indices, vertices);
+
+    // a face per cluster, all of its triangles facing the same way
+    const auto clusters = sr::buildClusters(indices, vertices, 32);
+    REQUIRE(clusters.size() == 6);
+    REQUIRE(clusters[0].coneCosine == Approx(1.0F));
+    REQUIRE(clusters[0].radius == Approx(std::sqrt(2.0F)));
+
+    sr::Texture frameBuffer{sr::PixelFormat::rgba8, width, height};
+    sr::Texture depthBuffer{sr::PixelFormat::float32, width, height};
+
+    sr::RenderPass renderPass;
+    renderPass.colorAttachment.texture = &frameBuffer;
+    renderPass.colorAttachment.loadAction = sr::RenderPass::LoadAction::clear;
+    renderPass.depthAttachment.texture = &depthBuffer;
+    renderPass.depthAttachment.loadAction = sr::RenderPass::LoadAction::clear;
+
+    sr::Matrix<float, 4> projection;
+    projection.setPerspective(sr::tau<float> / 6.0F, 1.0F, 1.0F, 100.0F);
+    sr::Matrix<float, 4> view;
+    view.setTranslation(0.0F, 0.0F, 5.0F);
+    sr::Matrix<float, 4> rotationX;
+    rotationX.setRotationX(0.4F);
+    sr::Matrix<float, 4> rotationY;
+    rotationY.setRotationY(0.5F);
+
+    auto drawCall = getQuadDrawCall(width, height);
+    drawCall.indices = indices;
+    drawCall.vertices = &vertices;
+    drawCall.modelViewProjection = projection * view * rotationY * rotationX;
+
+    drawTriangles(renderPass, {drawCall});
+    const auto image = frameBuffer.getData();
+
+    // the hidden faces are culled, triangle by triangle and cluster by cluster
+    drawCall.cullMode = sr::CullMode::back;
+
+    std::vector<sr::PipelineStatistics> statistics;
+    drawTriangles(renderPass, {drawCall}, nullptr, &statistics);
+    REQUIRE(frameBuffer.getData() == image);
+    REQUIRE(statistics[0].trianglesCulled == indices.size() / 6);
+
+    drawCall.clusters = &clusters;
+    drawTriangles(renderPass, {drawCall}, nullptr, &statistics);
+    REQUIRE(frameBuffer.getData() == image);
+    REQUIRE(statistics[0].clustersCulled == 3);
+    REQUIRE(statistics[0].vertexShaderInvocations == vertices.size() / 2);
+
+    drawCall.cullMode = sr::CullMode::front;
+    drawTriangles(renderPass, {drawCall}, nullptr, &statistics);
+    REQUIRE(frameBuffer.getData() != image);
+    REQUIRE(statistics[0].trianglesCulled == indices.size() / 6);
+
+    SECTION("Orthographic")
+    {
+        drawCall.cullMode = sr::CullMode::none;
+        drawCall.clusters = nullptr;
+        drawCall.modelViewProjection.setScale(sr::Vector<float, 3>{0.5F, 0.5F, 0.1F});
+        drawCall.modelViewProjection = drawCall.modelViewProjection * rotationY * rotationX;
+        drawCall.modelViewProjection.m[14] = 0.5F;
+
+        drawTriangles(renderPass, {drawCall});
+        const auto orthographicImage = frameBuffer.getData();
+
+        drawCall.cullMode = sr::CullMode::back;
+        drawCall.clusters = &clusters;
+        drawTriangles(renderPass, {drawCall}, nullptr, &statistics);
+        REQUIRE(frameBuffer.getData() == orthographicImage);
+        REQUIRE(statistics[0].clustersCulled == 3);
+    }
+
+    SECTION("Frustum")
+    {
+        // a cluster per quad, the right side of the cube is outside of the view
+        const auto quadClusters = sr::buildClusters(indices, vertices, 2);
+        sr::Matrix<float, 4> translation;
+        translation.setTranslation(2.5F, 0.0F, 0.0F);
+
+        drawCall.cullMode = sr::CullMode::none;
+        drawCall.clusters = nullptr;
+        drawCall.modelViewProjection = projection * view * translation * rotationY * rotationX;
+        drawTriangles(renderPass, {drawCall});
+        const auto shiftedImage = frameBuffer.getData();
+
+        drawCall.clusters = &quadClusters;
+        drawTriangles(renderPass, {drawCall}, nullptr, &statistics);
+        REQUIRE(frameBuffer.getData() == shiftedImage);
+        REQUIRE(statistics[0].clustersCulled > 0);
+        REQUIRE(statistics[0].vertexShaderInvocations < vertices.size());
+    }
+
+    SECTION("Invalid")
+    {
+        drawCall.topology = sr::PrimitiveTopology::triangleStrip;
+        REQUIRE_THROWS_AS(drawTriangles(renderPass, {drawCall}), sr::RenderError);
+    }
+}
+
+TEST_CASE("Occlusion culling", "[occlusion]")
+{
+    constexpr std::size_t width = 32;
+    constexpr std::size_t height = 32;
+
+    const auto box = [](const float minX, const float minY, const float minZ,
+                        const float maxX, const float maxY, const float maxZ) {
+        return sr::BoundingVolume::box(sr::Vector<float, 3>{minX, minY, minZ}, sr::Vector<float, 3>{maxX, maxY, maxZ});
+    };
+
+    // the red quad
+    sr::OcclusionBuffer occlusionBuffer;
+    REQUIRE(occlusionBuffer.getWidth() == 256);
+    REQUIRE(occlusionBuffer.getHeight() == 128);
+    REQUIRE(occlusionBuffer.isVisible(box(-0.2F, -0.2F, 0.5F, 0.2F, 0.2F, 0.6F), sr::Matrix<float, 4>::identity()));
+
+    const sr::IndexBufferView redIndices{quadIndices.data() + 6, 6};
+    occlusionBuffer.drawOccluder(redIndices, quadVertices, sr::Matrix<float, 4>::identity());
+
+    const auto identity = sr::Matrix<float, 4>::identity();
+    REQUIRE_FALSE(occlusionBuffer.isVisible(box(-0.2F, -0.2F, 0.5F, 0.2F, 0.2F, 0.6F), identity));
+    REQUIRE_FALSE(occlusionBuffer.isVisible(sr::BoundingVolume::sphere(sr::Vector<float, 3>{0.2F, 0.2F, 0.8F}, 0.1F), identity));
+    REQUIRE(occlusionBuffer.isVisible(box(-0.2F, -0.2F, 0.1F, 0.2F, 0.2F, 0.15F), identity)); // in front
+    REQUIRE(occlusionBuffer.isVisible(box(-0.5F, -0.2F, 0.5F, 0.2F, 0.2F, 0.6F), identity)); // reaches past the edge
+    REQUIRE(occlusionBuffer.isVisible(box(-0.2F, -0.403F, 0.5F, 0.2F, 0.2F, 0.6F), identity)); // less than half of a pixel past the edge
+    REQUIRE(occlusionBuffer.isVisible(sr::BoundingVolume{}, identity));
+    REQUIRE_FALSE(occlusionBuffer.isVisible(box(2.0F, -0.2F, 0.5F, 3.0F, 0.2F, 0.6F), identity)); // outside of the view
+
+    // crossing the plane of the camera
+    sr::Matrix<float, 4> projection;
+    projection.setPerspective(sr::tau<float> / 4.0F, 1.0F, 0.1F, 100.0F);
+    REQUIRE(occlusionBuffer.isVisible(box(-1.0F, -1.0F, -1.0F, 1.0F, 1.0F, 1.0F), projection));
+
+    occlusionBuffer.clear();
+    REQUIRE(occlusionBuffer.isVisible(box(-0.2F, -0.2F, 0.5F, 0.2F, 0.2F, 0.6F), identity));
+
+    SECTION("Draws")
+    {
+        sr::Texture frameBuffer{sr::PixelFormat::rgba8, width, height};
+        sr::Texture depthBuffer{sr::PixelFormat::float32, width, height};
+
+        sr::RenderPass renderPass;
+        renderPass.colorAttachment.texture = &frameBuffer;
+        renderPass.colorAttachment.loadAction = sr::RenderPass::LoadAction::clear;
+        renderPass.depthAttachment.texture = &depthBuffer;
+        renderPass.depthAttachment.loadAction = sr::RenderPass::LoadAction::clear;
+
+        // a small blue quad behind the red one
+        auto redDrawCall = getQuadDrawCall(width, height);
+        redDrawCall.indices = redIndices;
+
+        sr::Matrix<float, 4> translation;
+        translation.setTranslation(0.2F, 0.2F, 0.0F);
+        sr::Matrix<float, 4> scale;
+        scale.setScale(0.3F, 0.3F, 1.0F);
+
+        auto blueDrawCall = getQuadDrawCall(width, height);
+        blueDrawCall.indices = sr::IndexBufferView{quadIndices.data(), 6};
+        blueDrawCall.modelViewProjection = translation * scale;
+        blueDrawCall.bounds = box(-0.8F, -0.8F, 0.5F, 0.4F, 0.4F, 0.5F);
+
+        drawTriangles(renderPass, {redDrawCall, blueDrawCall});
+        const auto image = frameBuffer.getData();
+
+        occlusionBuffer.drawOccluder(redIndices, quadVertices, redDrawCall.modelViewProjection);
+        blueDrawCall.occlusionBuffer = &occlusionBuffer;
+
+        std::vector<sr::PipelineStatistics> statistics;
+        drawTriangles(renderPass, {redDrawCall, blueDrawCall}, nullptr, &statistics);
+
+        REQUIRE(frameBuffer.getData() == image);
+        REQUIRE(statistics[1].objectsCulled == 1);
+        REQUIRE(statistics[1].vertexShaderInvocations == 0);
+
+        sr::CommandBuffer commandBuffer;
+        commandBuffer.setOcclusionBuffer(&occlusionBuffer);
+        commandBuffer.drawTriangles(redIndices, quadVertices, redDrawCall.modelViewProjection);
+
+        std::vector<sr::DrawCall> drawCalls;
+        commandBuffer.getDrawCalls(drawCalls);
+        REQUIRE(drawCalls[0].occlusionBuffer == &occlusionBuffer);
+    }
+}
+
+TEST_CASE("Queries", "[query]")
+{
+    constexpr std::size_t width = 32;
+    constexpr std::size_t height = 32;
+
+    sr::Texture frameBuffer{sr::PixelFormat::rgba8, width, height};
+    sr::Texture depthBuffer{sr::PixelFormat::float32, width, height};
+
+    sr::RenderPass renderPass;
+    renderPass.colorAttachment.texture = &frameBuffer;
+    renderPass.colorAttachment.loadAction = sr::RenderPass::LoadAction::clear;
+    renderPass.depthAttachment.texture = &depthBuffer;
+    renderPass.depthAttachment.loadAction = sr::RenderPass::LoadAction::clear;
+
+    // one triangle of each quad, because the pixels on the diagonal of a quad are covered by both of its triangles,
+    // the red one goes first, so the blue one only passes the depth test where it is not hidden
+    auto redDrawCall = getQuadDrawCall(width, height);
+    redDrawCall.indices = sr::IndexBufferView{quadIndices.data() + 6, 3};
+    auto blueDrawCall = getQuadDrawCall(width, height);
+    blueDrawCall.indices = sr::IndexBufferView{quadIndices.data(), 3};
+
+    sr::Query redQuery{sr::QueryType::samplesPassed};
+    sr::Query blueQuery{sr::QueryType::samplesPassed};
+    redDrawCall.query = &redQuery;
+    blueDrawCall.query = &blueQuery;
+
+    std::uint64_t result = 1;
+    REQUIRE_FALSE(blueQuery.isAvailable());
+    REQUIRE_FALSE(blueQuery.getResult(result));
+    REQUIRE(result == 1);
+
+    drawTriangles(renderPass, {redDrawCall, blueDrawCall});
+
+    // the interpolated colors are not always exact
+    const auto countPixels = [&frameBuffer](const std::size_t channel) {
+        std::uint64_t count = 0;
+        for (std::size_t y = 0; y < height; ++y)
+            for (std::size_t x = 0; x < width; ++x)
+                if (frameBuffer.getData()[(y * width + x) * 4 + channel] >= 0x80U) ++count;
+        return count;
+    };
+
+    constexpr std::size_t red = 0;
+    constexpr std::size_t blue = 2;
+
+    REQUIRE(redQuery.getResult(result));
+    REQUIRE(result == countPixels(red));
+    REQUIRE(blueQuery.getResult(result));
+    REQUIRE(result == countPixels(blue));
+    const auto bluePixels = result;
+
+    // the samples of the tiles are added up from the worker threads
+    sr::JobSystem jobSystem{3};
+    renderPass.tileSize = 8;
+    redQuery.reset();
+    blueQuery.reset();
+    REQUIRE_FALSE(blueQuery.isAvailable());
+    drawTriangles(renderPass, {redDrawCall, blueDrawCall}, &jobSystem);
+    REQUIRE(blueQuery.getResult(result));
+    REQUIRE(result == bluePixels);
+    renderPass.tileSize = 0;
+
+    SECTION("Predicates")
+    {
+        // fully hidden behind the red quad
+        sr::Matrix<float, 4> scale;
+        scale.setScale(0.2F, 0.2F, 1.0F);
+        blueDrawCall.modelViewProjection = scale;
+        blueQuery.reset();
+        drawTriangles(renderPass, {redDrawCall, blueDrawCall});
+        REQUIRE(blueQuery.getResult(result));
+        REQUIRE(result == 0);
+
+        auto drawCall = getQuadDrawCall(width, height);
+        drawCall.indices = blueDrawCall.indices;
+        drawCall.predicate = &blueQuery;
+        drawTriangles(renderPass, {drawCall});
+        REQUIRE(countPixels(blue) == 0);
+
+        // drawn while the result is not known
+        blueQuery.reset();
+        drawTriangles(renderPass, {drawCall});
+        REQUIRE(countPixels(blue) > bluePixels);
+
+        drawCall.predicate = &redQuery;
+        drawTriangles(renderPass, {drawCall});
+        REQUIRE(countPixels(blue) != 0);
+    }
+
+    SECTION("Timestamps")
+    {
+        sr::Query begin{sr::QueryType::timestamp};
+        sr::Query geometry{sr::QueryType::timestamp};
+        sr::Query end{sr::QueryType::timestamp};
+        renderPass.beginTimestamp = &begin;
+        renderPass.geometryTimestamp = &geometry;
+        renderPass.endTimestamp = &end;
+
+        for (const auto tileSize : {std::size_t{0}, std::size_t{8}})
+        {
+            begin.reset();
+            geometry.reset();
+            end.reset();
+            renderPass.tileSize = tileSize;
+            drawTriangles(renderPass, {redDrawCall, blueDrawCall}, &jobSystem);
+
+            std::uint64_t beginTime = 0;
+            std::uint64_t geometryTime = 0;
+            std::uint64_t endTime = 0;
+            REQUIRE(begin.getResult(beginTime));
+            REQUIRE(geometry.getResult(geometryTime));
+            REQUIRE(end.getResult(endTime));
+            REQUIRE(beginTime <= geometryTime);
+            REQUIRE(geometryTime <= endTime);
+        }
+    }
+
+    SECTION("Command buffers")
+    {
+        sr::CommandBuffer commandBuffer;
+        commandBuffer.setShaders(colorVertexShader, colorFragmentShader);
+        commandBuffer.setViewport(sr::Rect<float>{0.0F, 0.0F, static_cast<float>(width), static_cast<float>(height)});
+        commandBuffer.setDepthState(redDrawCall.depthState);
+        commandBuffer.setPredicate(&redQuery);
+
+        sr::Query timestamp{sr::QueryType::timestamp};
+        REQUIRE_THROWS_AS(commandBuffer.beginQuery(timestamp), sr::RenderError);
+        REQUIRE_THROWS_AS(commandBuffer.setPredicate(&timestamp), sr::RenderError);
+
+        auto drawCall = redDrawCall;
+        drawCall.query = &timestamp;
+        REQUIRE_THROWS_AS(drawTriangles(renderPass, {drawCall}), sr::RenderError);
+        drawCall.query = nullptr;
+        drawCall.predicate = &timestamp;
+        REQUIRE_THROWS_AS(drawTriangles(renderPass, {drawCall}), sr::RenderError);
+
+        commandBuffer.drawTriangles(redDrawCall.indices, quadVertices, sr::Matrix<float, 4>::identity());
+        commandBuffer.beginQuery(blueQuery);
+        commandBuffer.drawTriangles(blueDrawCall.indices, quadVertices, sr::Matrix<float, 4>::identity());
+        commandBuffer.endQuery();
+
+        std::vector<sr::DrawCall> drawCalls;
+        commandBuffer.getDrawCalls(drawCalls);
+        REQUIRE(drawCalls[0].query == nullptr);
+        REQUIRE(drawCalls[0].predicate == &redQuery);
+        REQUIRE(drawCalls[1].query == &blueQuery);
+
+        // the result is polled without waiting for the queue
+        blueQuery.reset();
+        sr::CommandQueue commandQueue;
+        commandQueue.submit(renderPass, {commandBuffer});
+        (void)blueQuery.getResult(result);
+        commandQueue.waitIdle();
+        REQUIRE(blueQuery.getResult(result));
+        REQUIRE(result == bluePixels);
+    }
+}
+
+namespace
+{
+    sr::Color sampleFragmentShader(const sr::VertexShaderOutput& input,
+                                   const std::array<const sr::Sampler*, 2>& samplers,
+                                   const std::array<sr::TextureView, 2>& textures,
+                                   const sr::ConstantBuffer&)
+    {
+        return textures[0].sample(samplers[0], input.texCoords[0]);
+    }
+}
+
+TEST_CASE("Texture view", "[texture]")
+{
+    constexpr std::size_t width = 50;
+    constexpr std::size_t height = 40;
+    constexpr std::size_t pitch = 64 * 4;
+
+    sr::Texture frameBuffer{sr::PixelFormat::rgba8, width, height};
+
+    sr::RenderPass renderPass;
+    renderPass.colorAttachment.texture = &frameBuffer;
+    renderPass.colorAttachment.loadAction = sr::RenderPass::LoadAction::clear;
+    renderPass.depthAttachment.loadAction = sr::RenderPass::LoadAction::clear;
+    renderPass.depthAttachment.storeAction = sr::RenderPass::StoreAction::discard;
+    drawTriangles(renderPass, {getQuadDrawCall(width, height)});
+
+    // external memory with padded rows, of which only a part is used
+    std::vector<std::uint32_t> memory(pitch / 4 * (height + 2), 0xDEADBEEFU);
+    const sr::TextureView memoryView{sr::PixelFormat::rgba8, memory.data(), width + 2, height + 2, pitch};
+    const auto view = memoryView.getSubView(1, 2, width, height);
+
+    SECTION("Render")
+    {
+        renderPass.colorAttachment.texture = nullptr;
+        renderPass.colorAttachment.view = view;
+
+        SECTION("Immediate")
+        {
+            drawTriangles(renderPass, {getQuadDrawCall(width, height)});
+        }
+
+        SECTION("Tiled")
+        {
+            renderPass.tileSize = 16;
+            drawTriangles(renderPass, {getQuadDrawCall(width, height)});
+        }
+
+        bool same = true;
+        for (std::size_t y = 0; y < height; ++y)
+            for (std::size_t x = 0; x < width; ++x)
+                if (view.getPixel(x, y).getIntValueRaw() != getPixel(frameBuffer, x, y)) same = false;
+        REQUIRE(same);
+
+        // the memory outside of the view was not touched
+        REQUIRE(memory[0] == 0xDEADBEEFU);
+        REQUIRE(memory[2 * pitch / 4] == 0xDEADBEEFU);
+        REQUIRE(memory[2 * pitch / 4 + width + 1] == 0xDEADBEEFU);
+        REQUIRE(memory[2 * pitch / 4 + width + 2] == 0xDEADBEEFU);
+    }
+
+    SECTION("Clear and sample")
+    {
+        clear(view, sr::Color{0xFF0000FFU});
+        REQUIRE(memory[0] == 0xDEADBEEFU);
+
+        sr::Sampler sampler;
+        REQUIRE(view.sample(&sampler, sr::Vector<float, 2>{0.5F, 0.5F}).getIntValueRaw() == sr::Color{0xFF0000FFU}.getIntValueRaw());
+
+        // a draw samples the external memory without copying it into a texture,
+        // the texture coordinates of the quad vertices are 0
+        memory[2 * pitch / 4 + 1] = 0xFF00FF00U;
+        auto drawCall = getQuadDrawCall(width, height);
+        drawCall.fragmentShader = sampleFragmentShader;
+        drawCall.samplers = {&sampler, nullptr};
+        drawCall.textures = {view, sr::TextureView{}};
+        drawTriangles(renderPass, {drawCall});
+        REQUIRE(getPixel(frameBuffer, 25, 20) == 0xFF00FF00U);
+    }
+
+    SECTION("Multisampled")
+    {
+        // 4 pixels of 4 samples, every sample has its own value
+        std::vector<std::uint32_t> samples(4 * 4);
+        for (std::size_t i = 0; i < samples.size(); ++i)
+            samples[i] = 0xFF000000U | static_cast<std::uint32_t>(i);
+
+        const sr::TextureView multisampleView{sr::PixelFormat::rgba8, samples.data(), 4, 1, 0, 4};
+        REQUIRE(multisampleView.getPixel(2, 0).getIntValueRaw() == samples[8]);
+
+        sr::Sampler sampler;
+        sampler.filter = sr::Sampler::Filter::point;
+        for (std::size_t x = 0; x < 4; ++x)
+        {
+            const auto u = static_cast<float>(x) / 3.0F;
+            REQUIRE(multisampleView.sample(&sampler, sr::Vector<float, 2>{u, 0.0F}).getIntValueRaw() == samples[x * 4]);
+        }
+    }
+
+    SECTION("Invalid")
+    {
+        REQUIRE_THROWS(sr::TextureView{sr::PixelFormat::rgba8, memory.data(), width, height, width});
+        REQUIRE_THROWS(memoryView.getSubView(1, 2, width + 2, height));
+
+        renderPass.colorAttachment.texture = nullptr;
+        renderPass.colorAttachment.view = sr::TextureView{sr::PixelFormat::rgba8, memory.data(), width, height, width * 4 + 1};
+        REQUIRE_THROWS_AS(drawTriangles(renderPass, {getQuadDrawCall(width, height)}), sr::RenderError);
+    }
+}
+
+TEST_CASE("Sampler address modes", "[texture]")
+{
+    sr::Texture texture{sr::PixelFormat::rgba8, 5, 1};
+    texture.setData({
+        0x00, 0x00, 0x00, 0xFF, 0x01, 0x00, 0x00, 0xFF, 0x02, 0x00, 0x00, 0xFF,
+        0x03, 0x00, 0x00, 0xFF, 0x04, 0x00, 0x00, 0xFF
+    }, 0);
+
+    sr::Sampler sampler;
+    sampler.filter = sr::Sampler::Filter::point;
+
+    const auto sample = [&texture, &sampler](const float u) {
+        return texture.sample(&sampler, sr::Vector<float, 2>{u, 0.0F}).getIntValueRaw();
+    };
+    const auto pixel = [&texture](const std::size_t x) {
+        return texture.getPixel(x, 0, 0).getIntValueRaw();
+    };
+
+    sampler.addressModeX = sr::Sampler::AddressMode::clamp;
+    REQUIRE(sample(-0.25F) == pixel(0));
+    REQUIRE(sample(1.25F) == pixel(4));
+
+    sampler.addressModeX = sr::Sampler::AddressMode::repeat;
+    REQUIRE(sample(-0.25F) == pixel(3));
+    REQUIRE(sample(1.25F) == pixel(1));
+
+    sampler.addressModeX = sr::Sampler::AddressMode::mirror;
+    REQUIRE(sample(-0.25F) == pixel(1));
+    REQUIRE(sample(0.25F) == pixel(1));
+    REQUIRE(sample(1.25F) == pixel(3));
+}
+
+TEST_CASE("Pipeline statistics", "[statistics]")
+{
+    constexpr std::size_t width = 64;
+    constexpr std::size_t height = 48;
+
+    sr::Texture frameBuffer{sr::PixelFormat::rgba8, width, height};
+    sr::Texture depthBuffer{sr::PixelFormat::float32, width, height};
+
+    sr::RenderPass renderPass;
+    renderPass.colorAttachment.texture = &frameBuffer;
+    renderPass.colorAttachment.loadAction = sr::RenderPass::LoadAction::clear;
+    renderPass.depthAttachment.texture = &depthBuffer;
+    renderPass.depthAttachment.loadAction = sr::RenderPass::LoadAction::clear;
+
+    // the second draw is hidden behind the first one and cut by the scissor rectangle
+    auto frontDrawCall = getQuadDrawCall(width, height);
+    auto backDrawCall = getQuadDrawCall(width, height);
+    backDrawCall.modelViewProjection.setTranslation(0.0F, 0.0F, 0.1F);
+    backDrawCall.scissorRect = sr::Rect<float>{0.0F, 0.0F, 0.5F, 1.0F};
+    backDrawCall.blendState.enabled = true;
+
+    std::vector<sr::PipelineStatistics> statistics;
+    drawTriangles(renderPass, {frontDrawCall, backDrawCall}, nullptr, &statistics);
+
+    REQUIRE(statistics.size() == 2);
+
+    const auto& front = statistics[0];
+    REQUIRE(front.vertexShaderInvocations == quadVertices.size());
+    REQUIRE(front.trianglesSubmitted == quadIndices.size() / 3);
+    REQUIRE(front.trianglesCulled == 0);
+    REQUIRE(front.trianglesClipped == 0);
+    REQUIRE(front.pixelsCovered > 0);
+    REQUIRE(front.pixelsVisited >= front.pixelsCovered);
+    REQUIRE(front.depthTestsFailed == 0); // the red quad is drawn after the blue one and in front of it
+    REQUIRE(front.depthTestsPassed == front.pixelsCovered);
+    REQUIRE(front.fragmentShaderInvocations == front.depthTestsPassed);
+    REQUIRE(front.pixelsBlended == 0);
+
+    const auto& back = statistics[1];
+    REQUIRE(back.trianglesClipped > 0);
+    REQUIRE(back.pixelsCovered > 0);
+    REQUIRE(back.depthTestsFailed == back.pixelsCovered);
+    REQUIRE(back.fragmentShaderInvocations == 0);
+    REQUIRE(back.pixelsBlended == 0);
+
+    const auto isEqual = [](const sr::PipelineStatistics& a, const sr::PipelineStatistics& b) {
+        return a.objectsCulled == b.objectsCulled &&
+            a.vertexShaderInvocations == b.vertexShaderInvocations &&
+            a.trianglesSubmitted == b.trianglesSubmitted &&
+            a.trianglesCulled == b.trianglesCulled &&
+            a.trianglesClipped == b.trianglesClipped &&
+            a.pixelsVisited == b.pixelsVisited &&
+            a.pixelsCovered == b.pixelsCovered &&
+            a.depthTestsPassed == b.depthTestsPassed &&
+            a.depthTestsFailed == b.depthTestsFailed &&
+            a.fragmentShaderInvocations == b.fragmentShaderInvocations &&
+            a.pixelsBlended == b.pixelsBlended;
+    };
+
+    SECTION("Tiled")
+    {
+        sr::JobSystem jobSystem{3};
+        renderPass.tileSize = 16;
+
+        std::vector<sr::PipelineStatistics> tiledStatistics;
+        drawTriangles(renderPass, {frontDrawCall, backDrawCall}, &jobSystem, &tiledStatistics);
+
+        REQUIRE(tiledStatistics.size() == 2);
+        REQUIRE(isEqual(tiledStatistics[0], front));
+        REQUIRE(isEqual(tiledStatistics[1], back));
+    }
+
+    SECTION("Shared vertex buffer")
+    {
+        // the red quad in the middle of a large vertex buffer
+        std::vector<sr::Vertex> vertices;
+        for (std::size_t i = 0; i < 1000; ++i)
+            vertices.insert(vertices.end(), quadVertices.begin(), quadVertices.end());
+
+        const std::vector<std::uint32_t> indices{4004, 4005, 4006, 4005, 4007, 4006};
+        auto drawCall = getQuadDrawCall(width, height);
+        drawCall.indices = indices;
+        drawCall.vertices = &vertices;
+        drawTriangles(renderPass, {drawCall}, nullptr, &statistics);
+        const auto image = frameBuffer.getData();
+
+        REQUIRE(statistics[0].vertexShaderInvocations == 4);
+
+        drawCall.indices = sr::IndexBufferView{quadIndices.data() + 6, 6};
+        drawCall.vertices = &quadVertices;
+        drawTriangles(renderPass, {drawCall});
+        REQUIRE(frameBuffer.getData() == image);
+    }
+
+    SECTION("Command buffer")
+    {
+        sr::CommandBuffer commandBuffer;
+        commandBuffer.setShaders(frontDrawCall.vertexShader, frontDrawCall.fragmentShader);
+        commandBuffer.setViewport(frontDrawCall.viewport);
+        commandBuffer.setDepthState(frontDrawCall.depthState);
+        commandBuffer.drawTriangles(quadIndices, quadVertices, frontDrawCall.modelViewProjection);
+
+        sr::PipelineStatistics total;
+        execute(renderPass, {&commandBuffer}, true, nullptr, &total);
+
+        REQUIRE(isEqual(total, front));
+    }
+}
+
+TEST_CASE("Trace", "[trace]")
+{
+    constexpr std::size_t width = 64;
+    constexpr std::size_t height = 48;
+
+    sr::Texture frameBuffer{sr::PixelFormat::rgba8, width, height};
+
+    sr::RenderPass renderPass;
+    renderPass.colorAttachment.texture = &frameBuffer;
+    renderPass.colorAttachment.loadAction = sr::RenderPass::LoadAction::clear;
+    renderPass.depthAttachment.loadAction = sr::RenderPass::LoadAction::clear;
+    renderPass.depthAttachment.storeAction = sr::RenderPass::StoreAction::discard;
+    renderPass.tileSize = 16;
+
+    sr::JobSystem jobSystem{2};
+
+    // without a running tracer nothing is recorded
+    drawTriangles(renderPass, {getQuadDrawCall(width, height)}, &jobSystem);
+
+    sr::Tracer tracer{8};
+    tracer.start();
+    REQUIRE(sr::Tracer::getCurrent() == &tracer);
+
+    for (std::size_t i = 0; i < 10; ++i)
+        drawTriangles(renderPass, {getQuadDrawCall(width, height)}, &jobSystem);
+
+    tracer.stop();
+    REQUIRE(sr::Tracer::getCurrent() == nullptr);
+
+    std::ostringstream stream;
+    tracer.write(stream);
+    const auto trace = stream.str();
+
+    REQUIRE(trace.rfind("{\"traceEvents\":[", 0) == 0);
+    REQUIRE(trace.find("\"name\":\"drawTriangles\",\"ph\":\"X\"") != std::string::npos);
+    REQUIRE(trace.find("\"name\":\"tile\"") != std::string::npos);
+
+    // every thread keeps only the newest events
+    std::size_t events = 0;
+    for (auto position = trace.find("\"ph\":\"X\""); position != std::string::npos; position = trace.find("\"ph\":\"X\"", position + 1))
+        ++events;
+
+    std::size_t threads = 0;
+    for (auto position = trace.find("\"ph\":\"M\""); position != std::string::npos; position = trace.find("\"ph\":\"M\"", position + 1))
+        ++threads;
+
+    REQUIRE(threads >= 1);
+    REQUIRE(events <= threads * 8);
+}
+
+TEST_CASE("Performance counters", "[trace]")
+{
+    using Event = sr::PerformanceCounters::Event;
+
+    // the counters may be unavailable (no PMU, perf_event_paranoid), then they are reported as invalid
+    const sr::PerformanceCounters counters;
+    const auto begin = counters.read();
+    const auto end = counters.read();
+
+    for (std::size_t i = 0; i < sr::PerformanceCounters::eventCount; ++i)
+    {
+        const auto event = static_cast<Event>(i);
+        REQUIRE(begin.isValid(event) == counters.isAvailable(event));
+        if (counters.isAvailable(event))
+            REQUIRE(end[event] >= begin[event]);
+    }
+
+    sr::PerformanceCounters::Values a;
+    a.counts = {100, 200, 3, 2, 1};
+    a.valid = {true, true, true, false, true};
+
+    sr::PerformanceCounters::Values b;
+    b.counts = {40, 50, 1, 1, 2};
+    b.valid = {true, true, false, true, true};
+
+    const auto difference = a - b;
+    REQUIRE(difference[Event::cycles] == 60);
+    REQUIRE(difference[Event::instructions] == 150);
+    REQUIRE(!difference.isValid(Event::l1dMisses));
+    REQUIRE(!difference.isValid(Event::llcMisses));
+    REQUIRE(difference[Event::branchMisses] == 0); // the counters never go backwards
+
+    // the scopes of a counting tracer carry the deltas as arguments when the counters are available
+    sr::Tracer tracer{16, true};
+    tracer.start();
+    {
+        sr::TraceScope trace{"scope"};
+    }
+    tracer.stop();
+
+    std::ostringstream stream;
+    tracer.write(stream);
+    REQUIRE(stream.str().find("\"name\":\"scope\"") != std::string::npos);
+    if (counters.isAvailable(Event::cycles))
+        REQUIRE(stream.str().find("\"cycles\":") != std::string::npos);
+}
+
+TEST_CASE("Job system", "[jobsystem]")
+{
+    sr::JobSystem jobSystem{3};
+    REQUIRE(jobSystem.getThreadCount() == 3);
+    REQUIRE(jobSystem.getWorkerCount() == 4);
+    REQUIRE(jobSystem.getWorkerIndex() == 0);
+
+    SECTION("Parallel for")
+    {
+        std::vector<int> values(1000);
+        jobSystem.parallelFor(0, values.size(), 7, [&values](std::size_t begin, std::size_t end) {
+            for (auto i = begin; i < end; ++i) ++values[i];
+        });
+        REQUIRE(std::all_of(values.begin(), values.end(), [](int value) { return value == 1; }));
+    }
+
+    SECTION("Nested")
+    {
+        std::atomic<std::size_t> count{0};
+        jobSystem.parallelFor(0, 8, 1, [&](std::size_t, std::size_t) {
+            jobSystem.parallelFor(0, 8, 1, [&count](std::size_t, std::size_t) { ++count; });
+        });
+        REQUIRE(count == 64);
+    }
+
+    SECTION("Exception")
+    {
+        sr::JobSystem::JobGroup group;
+        jobSystem.run(group, []() { throw std::runtime_error{"Job failed"}; });
+        jobSystem.run(group, []() {});
+        REQUIRE_THROWS_AS(jobSystem.wait(group), std::runtime_error);
+        REQUIRE(group.isDone());
+    }
+
+    SECTION("Geometry")
+    {
+        constexpr std::size_t width = 64;
+        constexpr std::size_t height = 64;
+
+        // overlapping blended triangles, so that the image depends on the order of the triangles
+        std::vector<std::uint32_t> indices;
+        std::vector<sr::Vertex> vertices;
+        std::uint32_t seed = 1;
+        const auto random = [&seed]() {
+            seed = seed * 1664525U + 1013904223U;
+            return static_cast<float>(seed >> 8) / static_cast<float>(1U << 24) * 2.0F - 1.0F;
+        };
+
+        for (std::uint32_t i = 0; i < 3000 * 3; ++i)
+        {
+            indices.push_back(i);
+            vertices.push_back(sr::Vertex{sr::Vector<float, 4>{random(), random(), 0.5F, 1.0F}, sr::Color{seed | 0x80U}, sr::Vector<float, 2>{}, sr::Vector<float, 3>{}});
+        }
+
+        auto drawCall = getQuadDrawCall(width, height);
+        drawCall.indices = indices;
+        drawCall.vertices = &vertices;
+        drawCall.depthState.read = false;
+        drawCall.depthState.write = false;
+        drawCall.blendState.enabled = true;
+        drawCall.blendState.colorBlendSource = sr::BlendState::Factor::srcAlpha;
+        drawCall.blendState.colorBlendDest = sr::BlendState::Factor::invSrcAlpha;
+
+        sr::Texture serialFrameBuffer{sr::PixelFormat::rgba8, width, height};
+        sr::Texture parallelFrameBuffer{sr::PixelFormat::rgba8, width, height};
+
+        sr::RenderPass renderPass;
+        renderPass.colorAttachment.loadAction = sr::RenderPass::LoadAction::clear;
+        renderPass.depthAttachment.loadAction = sr::RenderPass::LoadAction::dontCare;
+        renderPass.depthAttachment.storeAction = sr::RenderPass::StoreAction::discard;
+
+        renderPass.colorAttachment.texture = &serialFrameBuffer;
+        drawTriangles(renderPass, {drawCall});
+
+        renderPass.colorAttachment.texture = &parallelFrameBuffer;
+        drawTriangles(renderPass, {drawCall}, &jobSystem);
+
+        REQUIRE(parallelFrameBuffer.getData() == serialFrameBuffer.getData());
+    }
+
+    SECTION("Tiled render pass")
+    {
+        constexpr std::size_t width = 50;
+        constexpr std::size_t height = 40;
+
+        sr::Texture serialFrameBuffer{sr::PixelFormat::rgba8, width, height, false, 4};
+        sr::Texture parallelFrameBuffer{sr::PixelFormat::rgba8, width, height, false, 4};
+
+        sr::RenderPass renderPass;
+        renderPass.colorAttachment.loadAction = sr::RenderPass::LoadAction::clear;
+        renderPass.depthAttachment.loadAction = sr::RenderPass::LoadAction::clear;
+        renderPass.depthAttachment.storeAction = sr::RenderPass::StoreAction::discard;
+        renderPass.tileSize = 8;
+
+        renderPass.colorAttachment.texture = &serialFrameBuffer;
+        drawTriangles(renderPass, {getQuadDrawCall(width, height)});
+
+        renderPass.colorAttachment.texture = &parallelFrameBuffer;
+        drawTriangles(renderPass, {getQuadDrawCall(width, height)}, &jobSystem);
+
+        REQUIRE(parallelFrameBuffer.getData() == serialFrameBuffer.getData());
+    }
+}
+
+TEST_CASE("Render passes on two threads", "[jobsystem]")
+{
+    constexpr std::size_t width = 512;
+    constexpr std::size_t height = 512;
+
+    // the calling threads are not workers, both of them run the tile jobs of the other pass while waiting
+    sr::JobSystem jobSystem{1};
+
+    const auto render = [&jobSystem](sr::Texture& frameBuffer, const sr::Color clearColor, const std::size_t frames) {
+        sr::RenderPass renderPass;
+        renderPass.colorAttachment.texture = &frameBuffer;
+        renderPass.colorAttachment.loadAction = sr::RenderPass::LoadAction::clear;
+        renderPass.colorAttachment.clearColor = clearColor;
+        renderPass.depthAttachment.loadAction = sr::RenderPass::LoadAction::clear;
+        renderPass.depthAttachment.storeAction = sr::RenderPass::StoreAction::discard;
+        renderPass.tileSize = 64;
+
+        drawTriangles(renderPass, {getQuadDrawCall(width, height)});
+        const auto image = frameBuffer.getData();
+
+        std::size_t differentFrames = 0;
+        for (std::size_t frame = 0; frame < frames; ++frame)
+        {
+            drawTriangles(renderPass, {getQuadDrawCall(width, height)}, &jobSystem);
+            if (frameBuffer.getData() != image) ++differentFrames;
+        }
+        return differentFrames;
+    };
+
+    sr::Texture frameBuffer1{sr::PixelFormat::rgba8, width, height};
+    sr::Texture frameBuffer2{sr::PixelFormat::rgba8, width, height};
+
+    std::size_t differentFrames = 0;
+    std::thread thread{[&]() { differentFrames = render(frameBuffer2, sr::Color{0x00FF00FFU}, 20); }};
+    const auto differentFrames1 = render(frameBuffer1, sr::Color{0x000000FFU}, 20);
+    thread.join();
+
+    REQUIRE(differentFrames1 == 0);
+    REQUIRE(differentFrames == 0);
+}
+
+namespace
+{
+    // the golden images are in the golden directory (SR_GOLDEN_PATH overrides it) together with the cost of
+    // every scene when the image was recorded, SR_UPDATE_GOLDEN=1 records them again instead of comparing
+    std::string getGoldenPath(const std::string& fileName)
+    {
+        const auto path = std::getenv("SR_GOLDEN_PATH");
+        return std::string{path ? path : "golden"} + "/" + fileName;
+    }
+
+    bool isUpdatingGolden()
+    {
+        const auto update = std::getenv("SR_UPDATE_GOLDEN");
+        return update && std::string{update} == "1";
+    }
+
+#if !defined(DEBUG)
+    // the recorded times depend on the machine, so the time budgets are checked only if SR_BUDGET_SCALE is set
+    // (1 on the machine that recorded them, more on slower ones), 0 if it is not
+    double getBudgetScale()
+    {
+        const auto scale = std::getenv("SR_BUDGET_SCALE");
+        return scale ? std::stod(scale) : 0.0;
+    }
+#endif
+
+    // BMP stores the pixels as BGRA
+    void saveImage(const std::string& path, const std::size_t width, const std::size_t height, std::vector<std::uint8_t> pixels)
+    {
+        for (std::size_t i = 0; i + 3 < pixels.size(); i += 4)
+            std::swap(pixels[i], pixels[i + 2]);
+
+        sr::bmp::Bmp bmp;
+        bmp.setData(width, height, pixels);
+        bmp.save(path);
+    }
+
+    std::vector<std::uint8_t> loadImage(const std::string& path, const std::size_t width, const std::size_t height)
+    {
+        const sr::bmp::Bmp bmp{path};
+        if (bmp.getWidth() != width || bmp.getHeight() != height)
+            throw std::runtime_error{"Golden image " + path + " has a different size"};
+
+        auto pixels = bmp.getData();
+        for (std::size_t i = 0; i + 3 < pixels.size(); i += 4)
+            std::swap(pixels[i], pixels[i + 2]);
+        return pixels;
+    }
+
+    class Tolerance final
+    {
+    public:
+        std::uint32_t channelDifference = 0; // a pixel differs if any of its channels differs by more than this
+        double differentPixels = 0.0; // fraction of the pixels that may differ
+    };
+
+    // pixels that are outside of the tolerance, the differences are written into the diff image
+    std::size_t compareImages(const std::vector<std::uint8_t>& actual,
+                              const std::vector<std::uint8_t>& expected,
+                              const Tolerance& tolerance,
+                              std::vector<std::uint8_t>& diff)
+    {
+        std::size_t result = 0;
+        diff.assign(actual.size(), 0);
+
+        for (std::size_t p = 0; p + 3 < actual.size(); p += 4)
+        {
+            std::uint32_t difference = 0;
+            for (std::size_t c = 0; c < 4; ++c)
+                difference = std::max(difference, static_cast<std::uint32_t>(std::abs(actual[p + c] - expected[p + c])));
+
+            if (difference > tolerance.channelDifference) ++result;
+
+            diff[p + 0] = static_cast<std::uint8_t>(std::min(difference * 16, 255U));
+            diff[p + 3] = 255;
+        }
+
+        return result;
+    }
+
+    class Cost final
+    {
+    public:
+        double milliseconds = 0.0;
+        std::uint64_t instructions = 0; // 0 if the counters are not available
+    };
+
+    // median time and the fewest instructions of several renders after a warm-up
+    template <class Render>
+    Cost measureCost(const Render& render)
+    {
+        constexpr std::size_t runs = 7;
+
+        const sr::PerformanceCounters counters;
+        std::vector<double> times;
+        Cost result;
+
+        render();
+
+        for (std::size_t run = 0; run < runs; ++run)
+        {
+            const auto begin = counters.read();
+            const auto start = std::chrono::steady_clock::now();
+            render();
+            const std::chrono::duration<double, std::milli> time = std::chrono::steady_clock::now() - start;
+            const auto delta = counters.read() - begin;
+
+            times.push_back(time.count());
+
+            if (delta.isValid(sr::PerformanceCounters::Event::instructions))
+            {
+                const auto instructions = delta[sr::PerformanceCounters::Event::instructions];
+                if (result.instructions == 0 || instructions < result.instructions)
+                    result.instructions = instructions;
+            }
+        }
+
+        std::sort(times.begin(), times.end());
+        result.milliseconds = times[runs / 2];
+        return result;
+    }
+
+    Cost loadCost(const std::string& path)
+    {
+        std::ifstream file{path};
+        if (!file)
+            throw std::runtime_error{"Failed to open " + path};
+
+        Cost result;
+        std::string key;
+        while (file >> key)
+            if (key == "milliseconds") file >> result.milliseconds;
+            else if (key == "instructions") file >> result.instructions;
+
+        return result;
+    }
+
+    void saveCost(const std::string& path, const Cost& cost)
+    {
+        std::ofstream file{path};
+        file << "milliseconds " << cost.milliseconds << '\n';
+        if (cost.instructions) file << "instructions " << cost.instructions << '\n';
+    }
+
+    // renders the scene, compares the color attachment with the golden image and checks that
+    // the scene does not cost twice as much as when the golden image was recorded
+    template <class Render>
+    void checkGolden(const std::string& imageName,
+                     const std::string& costName,
+                     const sr::Texture& target,
+                     const Tolerance& tolerance,
+                     const Render& render)
+    {
+        const auto imagePath = getGoldenPath(imageName + ".bmp");
+        const auto costPath = getGoldenPath(costName + ".cost");
+
+        render();
+        const auto& pixels = target.getData();
+        const auto cost = measureCost(render);
+
+        if (isUpdatingGolden())
+        {
+            if (imageName == costName) saveImage(imagePath, target.getWidth(), target.getHeight(), pixels);
+            saveCost(costPath, cost);
+            return;
+        }
+
+        std::vector<std::uint8_t> diff;
+        const auto differentPixels = compareImages(pixels, loadImage(imagePath, target.getWidth(), target.getHeight()), tolerance, diff);
+        const auto allowedPixels = static_cast<std::size_t>(tolerance.differentPixels * static_cast<double>(target.getWidth() * target.getHeight()));
+
+        if (differentPixels > allowedPixels)
+        {
+            // left next to the test executable for inspection
+            saveImage(costName + ".actual.bmp", target.getWidth(), target.getHeight(), pixels);
+            saveImage(costName + ".diff.bmp", target.getWidth(), target.getHeight(), diff);
+        }
+
+        INFO(costName << ": " << differentPixels << " pixels differ, " << allowedPixels << " allowed");
+        REQUIRE(differentPixels <= allowedPixels);
+
+        [[maybe_unused]] const auto baseline = loadCost(costPath);
+
+        // unoptimized builds can not be compared with the recorded costs
+#if !defined(DEBUG)
+        if (const auto budgetScale = getBudgetScale(); budgetScale > 0.0)
+        {
+            INFO(costName << ": " << cost.milliseconds << " ms, recorded " << baseline.milliseconds << " ms");
+            CHECK(cost.milliseconds <= 2.0 * baseline.milliseconds * budgetScale);
+        }
+
+        // the instruction counts do not depend on the machine or its load
+        if (cost.instructions && baseline.instructions)
+        {
+            INFO(costName << ": " << cost.instructions << " instructions, recorded " << baseline.instructions);
+            CHECK(cost.instructions <= baseline.instructions * 3 / 2);
+        }
+        else if (cost.instructions)
+            WARN(costName << ": no instruction count was recorded, the instruction budget is not checked "
+                 "(run SR_UPDATE_GOLDEN=1 on a machine with hardware counters)");
+#endif
+    }
+
+    sr::VertexShaderOutput texturedVertexShader(const sr::Matrix<float, 4>& modelViewProjection,
+                                                const sr::Vertex& vertex,
+                                                const sr::Instance&,
+                                                const sr::ConstantBuffer&)
+    {
+        sr::VertexShaderOutput result;
+        result.position = modelViewProjection * vertex.position;
+        result.color = vertex.color;
+        result.texCoords[0] = vertex.texCoords[0];
+        return result;
+    }
+
+    sr::Color texturedFragmentShader(const sr::VertexShaderOutput& input,
+                                     const std::array<const sr::Sampler*, 2>& samplers,
+                                     const std::array<sr::TextureView, 2>& textures,
+                                     const sr::ConstantBuffer&)
+    {
+        const auto sample = textures[0].sample(samplers[0], input.texCoords[0]);
+        return sr::Color{input.color.r * sample.r, input.color.g * sample.g, input.color.b * sample.b, input.color.a * sample.a};
+    }
+
+    // a checkerboard with a gradient, so that the filtering is visible
+    sr::Texture createCheckerTexture()
+    {
+        constexpr std::size_t size = 32;
+
+        std::vector<std::uint8_t> data(size * size * 4);
+        for (std::size_t y = 0; y < size; ++y)
+            for (std::size_t x = 0; x < size; ++x)
+            {
+                const auto pixel = &data[(y * size + x) * 4];
+                const auto dark = ((x / 4) + (y / 4)) % 2 == 0;
+                pixel[0] = static_cast<std::uint8_t>(dark ? x * 4 : 255);
+                pixel[1] = static_cast<std::uint8_t>(dark ? y * 4 : 255);
+                pixel[2] = static_cast<std::uint8_t>(dark ? 64 : 200);
+                pixel[3] = 255;
+            }
+
+        sr::Texture texture{sr::PixelFormat::rgba8, size, size};
+        texture.setData(data, 0);
+        return texture;
+    }
+
+    // a plane that recedes into the distance, with the texture repeated on it
+    const std::vector<std::uint16_t> planeIndices{0, 1, 2, 1, 3, 2};
+
+    const std::vector<sr::Vertex> planeVertices{
+        sr::Vertex{sr::Vector<float, 4>{-1.0F, 0.0F, -1.0F, 1.0F}, sr::Color{0xFFFFFFFFU}, sr::Vector<float, 2>{0.0F, 0.0F}, sr::Vector<float, 3>{}},
+        sr::Vertex{sr::Vector<float, 4>{-1.0F, 0.0F, 1.0F, 1.0F}, sr::Color{0xFFFFFFFFU}, sr::Vector<float, 2>{0.0F, 3.0F}, sr::Vector<float, 3>{}},
+        sr::Vertex{sr::Vector<float, 4>{1.0F, 0.0F, -1.0F, 1.0F}, sr::Color{0xFFFFFFFFU}, sr::Vector<float, 2>{3.0F, 0.0F}, sr::Vector<float, 3>{}},
+        sr::Vertex{sr::Vector<float, 4>{1.0F, 0.0F, 1.0F, 1.0F}, sr::Color{0xFFFFFFFFU}, sr::Vector<float, 2>{3.0F, 3.0F}, sr::Vector<float, 3>{}}
+    };
+}
+
+TEST_CASE("Golden images", "[golden]")
+{
+    constexpr std::size_t width = 160;
+    constexpr std::size_t height = 120;
+
+    // rasterization is deterministic, the tolerance only absorbs the rounding differences between compilers
+    const Tolerance tolerance{1, 0.001};
+
+    sr::Texture frameBuffer{sr::PixelFormat::rgba8, width, height};
+    sr::Texture depthBuffer{sr::PixelFormat::float32, width, height};
+
+    sr::RenderPass renderPass;
+    renderPass.colorAttachment.texture = &frameBuffer;
+    renderPass.colorAttachment.loadAction = sr::RenderPass::LoadAction::clear;
+    renderPass.colorAttachment.clearColor = sr::Color{0x202020FFU};
+    renderPass.depthAttachment.texture = &depthBuffer;
+    renderPass.depthAttachment.loadAction = sr::RenderPass::LoadAction::clear;
+
+    SECTION("Depth")
+    {
+        const auto drawCall = getQuadDrawCall(width, height);
+        checkGolden("depth", "depth", frameBuffer, tolerance, [&]() {
+            drawTriangles(renderPass, {drawCall});
+        });
+    }
+
+    SECTION("Blending")
+    {
+        auto vertices = quadVertices;
+        for (auto& vertex : vertices) vertex.color.a = 0.5F;
+
+        auto drawCall = getQuadDrawCall(width, height);
+        drawCall.vertices = &vertices;
+        drawCall.depthState.read = false;
+        drawCall.depthState.write = false;
+        drawCall.blendState.enabled = true;
+        drawCall.blendState.colorBlendSource = sr::BlendState::Factor::srcAlpha;
+        drawCall.blendState.colorBlendDest = sr::BlendState::Factor::invSrcAlpha;
+        drawCall.blendState.alphaBlendSource = sr::BlendState::Factor::one;
+        drawCall.blendState.alphaBlendDest = sr::BlendState::Factor::zero;
+
+        checkGolden("blending", "blending", frameBuffer, tolerance, [&]() {
+            drawTriangles(renderPass, {drawCall});
+        });
+    }
+
+    const auto texture = createCheckerTexture();
+
+    sr::Sampler sampler;
+    sampler.addressModeX = sr::Sampler::AddressMode::repeat;
+    sampler.addressModeY = sr::Sampler::AddressMode::repeat;
+    sampler.filter = sr::Sampler::Filter::linear;
+
+    sr::Matrix<float, 4> projection;
+    projection.setPerspective(sr::tau<float> / 6.0F, static_cast<float>(width) / static_cast<float>(height), 0.1F, 10.0F);
+
+    sr::Matrix<float, 4> view;
+    view.setTranslation(0.0F, -0.5F, 1.8F);
+
+    sr::DrawCall planeDrawCall;
+    planeDrawCall.vertexShader = texturedVertexShader;
+    planeDrawCall.fragmentShader = texturedFragmentShader;
+    planeDrawCall.samplers = {&sampler, nullptr};
+    planeDrawCall.textures = {sr::TextureView{texture}, sr::TextureView{}};
+    planeDrawCall.viewport = sr::Rect<float>{0.0F, 0.0F, static_cast<float>(width), static_cast<float>(height)};
+    planeDrawCall.depthState.read = true;
+    planeDrawCall.depthState.write = true;
+    planeDrawCall.indices = planeIndices;
+    planeDrawCall.vertices = &planeVertices;
+    planeDrawCall.modelViewProjection = projection * view;
+
+    SECTION("Texture")
+    {
+        checkGolden("texture", "texture", frameBuffer, tolerance, [&]() {
+            drawTriangles(renderPass, {planeDrawCall});
+        });
+    }
+
+    SECTION("Texture tiled")
+    {
+        // tiling must not change the image
+        sr::JobSystem jobSystem{2};
+        renderPass.tileSize = 32;
+
+        checkGolden("texture", "texture-tiled", frameBuffer, tolerance, [&]() {
+            drawTriangles(renderPass, {planeDrawCall}, &jobSystem);
+        });
+    }
+
+    SECTION("Multisampling")
+    {
+        sr::Texture multisampleFrameBuffer{sr::PixelFormat::rgba8, width, height, false, 4};
+
+        renderPass.colorAttachment.texture = &multisampleFrameBuffer;
+        renderPass.colorAttachment.storeAction = sr::RenderPass::StoreAction::discard;
+        renderPass.colorAttachment.resolveTexture = &frameBuffer;
+        renderPass.depthAttachment.texture = nullptr;
+        renderPass.depthAttachment.storeAction = sr::RenderPass::StoreAction::discard;
+        renderPass.tileSize = 32;
+
+        checkGolden("multisampling", "multisampling", frameBuffer, tolerance, [&]() {
+            drawTriangles(renderPass, {planeDrawCall, getQuadDrawCall(width, height)});
+        });
+    }
+}